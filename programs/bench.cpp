@@ -0,0 +1,328 @@
+#include <emp-tool/emp-tool.h>
+#include "emp-tool/io/net_io.h"
+#include "emp-tool/io/simulated_wan.h"
+#include "emp-ag2pc/2pc.h"
+#include "emp-agmpc/emp-agmpc.h"
+#include <sstream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+using namespace std;
+using namespace emp;
+
+// Usage: ./build/bench <circuit file> <2pc|mpc> [parties, default 2] [port, default 12345]
+//
+// The circuit is Bristol text, or the binary layout if the file ends in .bin.
+// Runs every party of one circuit in its own process over loopback TCP and
+// prints one JSON object with each party's per-phase wall time, CPU time,
+// bytes sent and send rounds, the live and peak bytes of the tagged buffers
+// (see mem_account.h), and its peak RSS. Inputs are all zero; the
+// point is the cost, not the result. See scripts/bench.sh for the matrix.
+//
+// WAN_LATENCY_MS (one way), WAN_BANDWIDTH (bytes/s), WAN_JITTER_MS and
+// WAN_SEED slow every link down with SimulatedWAN, so that round trips cost
+// what they would over a real network.
+//
+// EMP_TRACE=trace.json writes the spans of all parties (see trace.h) to one
+// Chrome trace_event file, for chrome://tracing or https://ui.perfetto.dev.
+
+struct Phase {
+    string name;
+    double wall_us;
+    double cpu_us;
+    uint64_t bytes;
+    uint64_t rounds;
+    int64_t mem_live;
+    int64_t mem_peak;
+};
+
+struct IOStats {
+    uint64_t bytes;
+    uint64_t rounds;
+};
+
+double cpu_time_us() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1e6
+        + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+}
+
+long peak_rss_kb() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;
+#else
+    return ru.ru_maxrss;
+#endif
+}
+
+// Records one Phase per call to end(), as the difference since the previous
+// one.
+class PhaseTimer {
+public:
+    vector<Phase> phases;
+
+    PhaseTimer(std::function<IOStats()> io_stats): io_stats(io_stats) {
+        start();
+    }
+
+    void end(const string& name) {
+        IOStats now = io_stats();
+        phases.push_back({
+            name,
+            time_from(wall),
+            cpu_time_us() - cpu,
+            now.bytes - last.bytes,
+            now.rounds - last.rounds,
+            MemAccount::get().live(),
+            MemAccount::get().phase_peak()
+        });
+        start();
+    }
+
+private:
+    std::function<IOStats()> io_stats;
+    time_point<high_resolution_clock> wall;
+    double cpu;
+    IOStats last;
+
+    void start() {
+        last = io_stats();
+        MemAccount::get().begin_phase();
+        cpu = cpu_time_us();
+        wall = clock_start();
+    }
+};
+
+std::optional<WANConfig> wan_from_env() {
+    const char* latency = getenv("WAN_LATENCY_MS");
+    const char* bandwidth = getenv("WAN_BANDWIDTH");
+    const char* jitter = getenv("WAN_JITTER_MS");
+    const char* seed = getenv("WAN_SEED");
+    if (!latency and !bandwidth and !jitter)
+        return std::nullopt;
+    WANConfig wan;
+    wan.latency_ms = latency ? atof(latency) : 0;
+    wan.bandwidth = bandwidth ? atof(bandwidth) : 0;
+    wan.jitter_ms = jitter ? atof(jitter) : 0;
+    wan.seed = seed ? strtoull(seed, nullptr, 10) : 1;
+    return wan;
+}
+
+vector<Phase> run_2pc(BristolFormat& cf, int party, int port, std::optional<WANConfig> wan) {
+    std::shared_ptr<IRawIO> raw_io = std::make_shared<NetIO>(party == ALICE ? nullptr : IP, port);
+    if (wan) {
+        WANConfig config = *wan;
+        config.seed ^= party;
+        raw_io = std::make_shared<SimulatedWAN>(raw_io, config);
+    }
+    IOChannel io(raw_io);
+    PhaseTimer timer([&]() { return IOStats{*io.counter, *io.rounds}; });
+
+    C2PC twopc(io, party, &cf);
+    io.flush();
+    timer.end("setup");
+
+    twopc.function_independent();
+    io.flush();
+    timer.end("function_independent");
+
+    twopc.function_dependent();
+    io.flush();
+    timer.end("function_dependent");
+
+    std::vector<bool> in(party == ALICE ? cf.n1 : cf.n2, false);
+    twopc.online(in, true);
+    io.flush();
+    timer.end("online");
+
+    return timer.phases;
+}
+
+// Bytes are summed over all parties. Rounds are those with the busiest
+// party, since the links to different parties run side by side.
+IOStats multi_io_stats(IMultiIO& io) {
+    IOStats res{0, 0};
+    for (int i = 1; i <= io.size(); ++i) {
+        if (i != io.party()) {
+            res.bytes += *io.a_channel(i).counter + *io.b_channel(i).counter;
+            // a_channel and b_channel share their rounds, see NetIOMP
+            res.rounds = max(res.rounds, *io.a_channel(i).rounds);
+        }
+    }
+    return res;
+}
+
+vector<Phase> run_mpc(BristolFormat& cf, int nP, int party, int port, std::optional<WANConfig> wan) {
+    std::shared_ptr<IMultiIO> io = std::make_shared<NetIOMP>(nP, party, port, wan);
+    PhaseTimer timer([&]() { return multi_io_stats(*io); });
+
+    CMPC mpc(io, &cf);
+    timer.end("setup");
+
+    mpc.function_independent();
+    timer.end("function_independent");
+
+    mpc.function_dependent();
+    timer.end("function_dependent");
+
+    // n1 bits from party 1 and n2 from party 2, like the 2PC run
+    FlexIn input(nP, cf.n1 + cf.n2, party);
+    for (int i = 0; i < cf.n1 + cf.n2; ++i) {
+        int owner = i < cf.n1 ? 1 : 2;
+        input.assign_party(i, owner);
+        if (owner == party)
+            input.assign_plaintext_bit(i, false);
+    }
+    FlexOut output(nP, cf.n3, party);
+    for (int i = 0; i < cf.n3; ++i)
+        output.assign_party(i, 0);
+
+    mpc.online(&input, &output);
+    timer.end("online");
+
+    return timer.phases;
+}
+
+string party_json(int party, const vector<Phase>& phases) {
+    stringstream ss;
+    ss << "{\"party\": " << party << ", \"phases\": [";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const Phase& p = phases[i];
+        ss << (i ? ", " : "") << "{\"name\": \"" << p.name << "\""
+           << ", \"wall_us\": " << (uint64_t)p.wall_us
+           << ", \"cpu_us\": " << (uint64_t)p.cpu_us
+           << ", \"bytes\": " << p.bytes
+           << ", \"rounds\": " << p.rounds
+           << ", \"mem_live\": " << p.mem_live
+           << ", \"mem_peak\": " << p.mem_peak << "}";
+    }
+    ss << "], \"peak_rss_kb\": " << peak_rss_kb()
+       << ", \"memory\": " << MemAccount::get().to_json() << "}";
+    return ss.str();
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        cerr << "usage: " << argv[0] << " <circuit file> <2pc|mpc> [parties] [port]" << endl;
+        return 1;
+    }
+    string circuit = argv[1];
+    string mode = argv[2];
+    int nP = argc > 3 ? atoi(argv[3]) : 2;
+    int port = argc > 4 ? atoi(argv[4]) : 12345;
+    std::optional<WANConfig> wan = wan_from_env();
+    const char* trace = getenv("EMP_TRACE");
+
+    if (mode != "2pc" and mode != "mpc") {
+        cerr << "mode must be 2pc or mpc" << endl;
+        return 1;
+    }
+    if (mode == "2pc" ? nP != 2 : (nP < 2 or nP > 8)) {
+        cerr << "2pc needs 2 parties, mpc 2 to 8" << endl;
+        return 1;
+    }
+
+    BristolFormat cf;
+    if (circuit.size() > 4 and circuit.substr(circuit.size() - 4) == ".bin") {
+        // binary layout, as written by gen_circuit --binary
+        std::ifstream f(circuit, std::ios::binary);
+        std::vector<uint8_t> buf((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        if (!f.good() and !f.eof())
+            throw std::runtime_error("Cannot read " + circuit);
+        cf.from_buffer(buf.data(), buf.size());
+    } else {
+        cf.from_file(circuit.c_str());
+    }
+    int num_ands = 0;
+    for (int i = 0; i < cf.num_gate; ++i)
+        if (cf.gates[4*i+3] == AND_GATE)
+            ++num_ands;
+
+    // one process per party, so CPU time and RSS are per party
+    vector<pid_t> pids;
+    vector<int> fds;
+    for (int party = 1; party <= nP; ++party) {
+        int fd[2];
+        if (pipe(fd) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fd[0]);
+            // keep the protocol's own prints out of the JSON
+            freopen("/dev/null", "w", stdout);
+            if (trace)
+                Tracer::get().enable(party);
+            vector<Phase> phases = mode == "2pc"
+                ? run_2pc(cf, party, port, wan)
+                : run_mpc(cf, nP, party, port, wan);
+            if (trace) {
+                std::ofstream f(string(trace) + "." + to_string(party));
+                f << Tracer::get().events_json();
+            }
+            string res = party_json(party, phases);
+            if (write(fd[1], res.data(), res.size()) != (ssize_t)res.size())
+                _exit(1);
+            _exit(0);
+        }
+        close(fd[1]);
+        pids.push_back(pid);
+        fds.push_back(fd[0]);
+    }
+
+    vector<string> results;
+    bool ok = true;
+    for (int i = 0; i < nP; ++i) {
+        string res;
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fds[i], buf, sizeof(buf))) > 0)
+            res.append(buf, n);
+        close(fds[i]);
+        int status;
+        waitpid(pids[i], &status, 0);
+        ok = ok and WIFEXITED(status) and WEXITSTATUS(status) == 0;
+        results.push_back(res);
+    }
+    if (!ok) {
+        cerr << "a party failed" << endl;
+        return 1;
+    }
+
+    if (trace) {
+        // one file with a pid per party, all on the same clock
+        std::ofstream out(trace);
+        string sep = "\n";
+        out << "{\"traceEvents\": [";
+        for (int party = 1; party <= nP; ++party) {
+            string path = string(trace) + "." + to_string(party);
+            std::ifstream in(path);
+            string events((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (!events.empty()) {
+                out << sep << events;
+                sep = ",\n";
+            }
+            remove(path.c_str());
+        }
+        out << "\n], \"displayTimeUnit\": \"ms\"}" << endl;
+    }
+
+    cout << "{\"circuit\": \"" << circuit << "\", \"mode\": \"" << mode << "\""
+         << ", \"parties\": " << nP
+         << ", \"gates\": " << cf.num_gate << ", \"ands\": " << num_ands;
+    if (wan)
+        cout << ", \"wan\": {\"latency_ms\": " << wan->latency_ms
+             << ", \"bandwidth\": " << wan->bandwidth
+             << ", \"jitter_ms\": " << wan->jitter_ms
+             << ", \"seed\": " << wan->seed << "}";
+    cout << ", \"results\": [";
+    for (int i = 0; i < nP; ++i)
+        cout << (i ? ", " : "") << results[i];
+    cout << "]}" << endl;
+
+    return 0;
+}
@@ -0,0 +1,80 @@
+#include <emp-tool/emp-tool.h>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+using namespace emp;
+
+// Usage: ./build/gen_circuit [--binary] [key=value...] > circuit.txt
+//
+// Writes a synthetic circuit (see SyntheticCircuitSpec) to stdout, as Bristol
+// text or, with --binary, in the layout BristolFormat::from_buffer reads.
+// Keys: ands, xor_ratio, depth, width, n1, n2, n3, seed. For example
+//   ./build/gen_circuit --binary ands=1000000 width=1000 > build/1m.bin
+// Gates are written as they are generated, so 10^8 ANDs need no more memory
+// than 10^3.
+
+void write_u32(FILE* f, uint32_t v) {
+    uint8_t b[4] = {uint8_t(v), uint8_t(v >> 8), uint8_t(v >> 16), uint8_t(v >> 24)};
+    fwrite(b, 1, 4, f);
+}
+
+int main(int argc, char** argv) {
+    SyntheticCircuitSpec spec;
+    bool binary = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        if (arg == "--binary") {
+            binary = true;
+            continue;
+        }
+        if (eq == string::npos) {
+            cerr << "expected key=value, got " << arg << endl;
+            return 1;
+        }
+        string key = arg.substr(0, eq);
+        const char* value = argv[i] + eq + 1;
+        if (key == "ands") spec.num_and = atoll(value);
+        else if (key == "xor_ratio") spec.xor_ratio = atof(value);
+        else if (key == "depth") spec.depth = atoll(value);
+        else if (key == "width") spec.width = atoll(value);
+        else if (key == "n1") spec.n1 = atoi(value);
+        else if (key == "n2") spec.n2 = atoi(value);
+        else if (key == "n3") spec.n3 = atoi(value);
+        else if (key == "seed") spec.seed = strtoull(value, nullptr, 10);
+        else {
+            cerr << "unknown key " << key << endl;
+            return 1;
+        }
+    }
+
+    try {
+        spec.check();
+    } catch (const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (binary) {
+        for (int64_t v : {spec.num_gate(), spec.num_wire(), (int64_t)spec.n1, (int64_t)spec.n2, (int64_t)spec.n3})
+            write_u32(out, v);
+    } else {
+        fprintf(out, "%lld %lld\n%d %d %d\n\n", (long long)spec.num_gate(),
+                (long long)spec.num_wire(), spec.n1, spec.n2, spec.n3);
+    }
+
+    generate_synthetic_circuit(spec, [&](int in1, int in2, int wire, int type) {
+        if (binary) {
+            fputc(type == XOR_GATE ? 1 : 2, out);
+            write_u32(out, in1);
+            write_u32(out, in2);
+            write_u32(out, wire);
+        } else {
+            fprintf(out, "2 1 %d %d %d %s\n", in1, in2, wire, type == XOR_GATE ? "XOR" : "AND");
+        }
+    });
+
+    return fflush(out) == 0 ? 0 : 1;
+}
@@ -45,6 +45,9 @@ class RawIOJS;
 std::map<int, RawIOJS*> raw_io_map;
 int next_raw_io_id = 0;
 size_t MAX_SEND_BUFFER_SIZE = 64 * 1024;
+// over all channels, as handed to and taken from JavaScript
+uint64_t total_bytes_sent = 0;
+uint64_t total_bytes_received = 0;
 
 void actual_flush_all();
 
@@ -112,6 +115,7 @@ public:
             actual_flush_all();
             size_t bytes_received = recv_js(other_party, channel_label, recv_buffer.data() + recv_end, bytes_needed, room);
             recv_end += bytes_received;
+            total_bytes_received += bytes_received;
 
             if (bytes_received < bytes_needed) {
                 throw std::runtime_error("recv failed");
@@ -129,6 +133,7 @@ public:
     void actual_flush() {
         if (send_buffer.size() > 0) {
             send_js(other_party, channel_label, send_buffer.data(), send_buffer.size());
+            total_bytes_sent += send_buffer.size();
             send_buffer.clear();
         }
     }
@@ -152,6 +157,7 @@ public:
         for (int i = 0; i <= nP; i++) {
             a_channels.emplace_back(std::make_shared<RawIOJS>(i, 'a'));
             b_channels.emplace_back(std::make_shared<RawIOJS>(i, 'b'));
+            b_channels[i].share_rounds(a_channels[i]);
         }
     }
 
@@ -267,6 +273,172 @@ EM_JS(size_t, get_input_bits_per_party, (int i), {
     return res;
 });
 
+EM_JS(int, get_statistical_security, (), {
+    const ssp = Module.emp?.statisticalSecurity ?? 40;
+
+    // the garbled rows and output MACs are checked on 5 bytes (C2PC::SSP,
+    // CMPC::SSP) and C2PC's MASK keeps 20 bits, so asking for more than 40
+    // bits would not get them
+    if (!Number.isInteger(ssp) || ssp < 1 || ssp > 40) {
+        throw new Error("Module.emp.statisticalSecurity must be an integer in [1, 40].");
+    }
+
+    return ssp;
+});
+
+EM_JS(int, get_evaluator, (int nP), {
+    const evaluator = Module.emp?.evaluator ?? 0;
+
+    if (!Number.isInteger(evaluator) || evaluator < 0 || evaluator >= nP) {
+        throw new Error("Module.emp.evaluator must be a party index in [0, size).");
+    }
+
+    return evaluator + 1;
+});
+
+EM_JS(int, get_output_bits_per_party, (int i), {
+    const outputBitsPerParty = Module.emp?.outputBitsPerParty;
+
+    // every party receives every output bit
+    if (!outputBitsPerParty) {
+        return -1;
+    }
+
+    if (i >= outputBitsPerParty.length) {
+        throw new Error("Index out of bounds for Module.emp.outputBitsPerParty.");
+    }
+
+    const res = outputBitsPerParty[i];
+
+    if (!Number.isInteger(res) || res < 0) {
+        throw new Error("Module.emp.outputBitsPerParty must hold non-negative integers.");
+    }
+
+    return res;
+});
+
+// The party (1-based) that receives each output bit, 0 for all of them.
+// Groups follow outputBitsPerParty: party 0's bits first, then party 1's...
+std::vector<int> get_output_parties(int nP, int n3) {
+    std::vector<int> output_parties(n3, 0);
+
+    if (get_output_bits_per_party(0) < 0) {
+        return output_parties;
+    }
+
+    int pos = 0;
+    for (int p = 0; p < nP; p++) {
+        int bits = get_output_bits_per_party(p);
+
+        if (pos + bits > n3) {
+            throw std::runtime_error("Mismatch between circuit and outputBitsPerParty");
+        }
+
+        for (int i = 0; i < bits; i++) {
+            output_parties[pos++] = p + 1;
+        }
+    }
+
+    if (pos != n3) {
+        throw std::runtime_error("Mismatch between circuit and outputBitsPerParty");
+    }
+
+    return output_parties;
+}
+
+// Tells JavaScript that a phase (setup, function_independent,
+// function_dependent, online) has finished, and how big the heap is now.
+EM_JS(void, report_phase_raw, (const char* phase), {
+    Module.emp?.onPhase?.(UTF8ToString(phase), HEAPU8.length);
+});
+
+EM_JS(int, wants_memory, (), {
+    return Module.emp?.onMemory ? 1 : 0;
+});
+
+// Hands the tagged buffers (see mem_account.h) at the end of a phase to
+// JavaScript.
+EM_JS(void, report_memory_raw, (const char* phase, const char* json), {
+    Module.emp?.onMemory?.({
+        phase: UTF8ToString(phase),
+        heapBytes: HEAPU8.length,
+        ...JSON.parse(UTF8ToString(json)),
+    });
+});
+
+void start_memory() {
+    emp::MemAccount::get().reset();
+    emp::MemAccount::get().begin_phase();
+}
+
+void report_phase(const char* phase) {
+    report_phase_raw(phase);
+    if (wants_memory()) {
+        report_memory_raw(phase, emp::MemAccount::get().to_json().c_str());
+    }
+    emp::MemAccount::get().begin_phase();
+}
+
+EM_JS(int, wants_progress, (), {
+    return Module.emp?.onProgress ? 1 : 0;
+});
+
+// The ETA extrapolates the rate so far in the current phase.
+EM_JS(void, report_progress_js, (const char* phase, double done, double total, double bytes_sent, double bytes_received), {
+    const name = UTF8ToString(phase);
+    const now = performance.now();
+
+    if (Module.progressPhase !== name) {
+        Module.progressPhase = name;
+        Module.progressPhaseStart = now;
+    }
+
+    const elapsed = now - Module.progressPhaseStart;
+
+    Module.emp?.onProgress?.({
+        phase: name,
+        done,
+        total,
+        bytesSent: bytes_sent,
+        bytesReceived: bytes_received,
+        phaseEtaMs: done > 0 ? elapsed * (total - done) / done : undefined,
+    });
+});
+
+// Forwards the protocol's progress (see progress.h) to JavaScript, at most
+// four times a second.
+void start_progress() {
+    if (wants_progress()) {
+        emp::Progress::get().set_handler([](const char* phase, int64_t done, int64_t total) {
+            report_progress_js(phase, done, total, total_bytes_sent, total_bytes_received);
+        }, 250);
+    }
+}
+
+EM_JS(int, wants_trace, (), {
+    return Module.emp?.onTrace ? 1 : 0;
+});
+
+// Hands the spans of this run (see trace.h) to JavaScript as Chrome
+// trace_event JSON.
+EM_JS(void, report_trace_raw, (const char* json), {
+    Module.emp?.onTrace?.(UTF8ToString(json));
+});
+
+void start_trace(int party) {
+    if (wants_trace()) {
+        emp::Tracer::get().clear();
+        emp::Tracer::get().enable(party - 1);
+    }
+}
+
+void report_trace() {
+    if (emp::Tracer::get().enabled()) {
+        emp::Tracer::get().disable();
+        report_trace_raw(emp::Tracer::get().to_json().c_str());
+    }
+}
+
 EM_JS(void, handle_output_bits_raw, (uint8_t* outputBits, int length), {
     if (!Module.emp?.handleOutput) {
         throw new Error("Module.emp.handleOutput is not defined in JavaScript.");
@@ -310,6 +482,15 @@ extern "C" {
         run_mpc_impl(party + 1, size);
     }
 
+    // The tagged buffers right now (see mem_account.h), as JSON. The string
+    // stays valid until the next call.
+    EMSCRIPTEN_KEEPALIVE
+    const char* memory_report() {
+        static std::string report;
+        report = emp::MemAccount::get().to_json();
+        return report.c_str();
+    }
+
     EMSCRIPTEN_KEEPALIVE
     uint8_t* js_malloc(int size) {
         return (uint8_t*)malloc(size);
@@ -354,14 +535,33 @@ void run_2pc_impl(int party, int nP) {
             }
         }
 
-        auto twopc = emp::C2PC(io, party, &circuit);
+        // PUBLIC, ALICE and BOB are 0, 1 and 2, as in get_output_parties
+        std::vector<int> output_parties = get_output_parties(2, circuit.n3);
+
+        start_trace(party);
+        start_progress();
+        start_memory();
+        auto twopc = emp::C2PC(io, party, &circuit, get_statistical_security());
+        report_phase("setup");
 
         twopc.function_independent();
+        report_phase("function_independent");
+
         twopc.function_dependent();
+        report_phase("function_dependent");
 
-        std::vector<bool> output_bits = twopc.online(input_bits, true);
+        std::vector<bool> all_output_bits = twopc.online(input_bits, output_parties);
+        report_phase("online");
+        std::vector<bool> output_bits;
+
+        for (int i = 0; i < circuit.n3; i++) {
+            if (output_parties[i] == 0 || output_parties[i] == party) {
+                output_bits.push_back(all_output_bits[i]);
+            }
+        }
 
         actual_flush_all();
+        report_trace();
 
         handle_output_bits(output_bits);
     } catch (const std::exception& e) {
@@ -373,10 +573,17 @@ void run_mpc_impl(int party, int nP) {
     try {
         std::shared_ptr<IMultiIO> io = std::make_shared<MultiIOJS>(party, nP);
         auto circuit = get_circuit();
-        auto mpc = CMPC(io, &circuit);
+        start_trace(party);
+        start_progress();
+        start_memory();
+        auto mpc = CMPC(io, &circuit, nullptr, get_statistical_security(), get_evaluator(nP));
+        report_phase("setup");
 
         mpc.function_independent();
+        report_phase("function_independent");
+
         mpc.function_dependent();
+        report_phase("function_dependent");
 
         std::vector<bool> input_bits = get_input_bits();
 
@@ -403,22 +610,26 @@ void run_mpc_impl(int party, int nP) {
 
         assert(bit_pos == circuit.n1 + circuit.n2);
 
+        std::vector<int> output_parties = get_output_parties(nP, circuit.n3);
         FlexOut output(nP, circuit.n3, party);
 
         for (int i = 0; i < circuit.n3; i++) {
-            // All parties receive the output.
-            output.assign_party(i, 0);
+            output.assign_party(i, output_parties[i]);
         }
 
         mpc.online(&input, &output);
+        report_phase("online");
 
         std::vector<bool> output_bits;
 
         for (int i = 0; i < circuit.n3; i++) {
-            output_bits.push_back(output.get_plaintext_bit(i));
+            if (output_parties[i] == 0 || output_parties[i] == party) {
+                output_bits.push_back(output.get_plaintext_bit(i));
+            }
         }
 
         actual_flush_all();
+        report_trace();
 
         handle_output_bits(output_bits);
     } catch (const std::exception& e) {
@@ -1,5 +1,6 @@
 #include <emp-tool/emp-tool.h>
 #include "emp-tool/io/net_io.h"
+#include "emp-tool/io/simulated_wan.h"
 #include "emp-ag2pc/2pc.h"
 using namespace std;
 using namespace emp;
@@ -13,6 +14,45 @@ const string circuit_file_location = "circuits/sha-1.txt";
 // can be independently calculated eg with https://xorbin.com/tools/sha1-hash-calculator
 const string sha1_empty = "da39a3ee5e6b4b0d3255bfef95601890afd80709";
 
+std::vector<bool> run(C2PC& twopc, IOChannel& io, int party, const std::vector<bool>& in, const std::vector<int>* output_party = nullptr) {
+    auto t1 = clock_start();
+    twopc.function_independent();
+    io.flush();
+    cout << "inde:\t" << party << "\t" << time_from(t1) << endl;
+
+    t1 = clock_start();
+    twopc.function_dependent();
+    io.flush();
+    cout << "dep:\t" << party << "\t" << time_from(t1) << endl;
+
+    t1 = clock_start();
+    std::vector<bool> out = output_party ? twopc.online(in, *output_party) : twopc.online(in, true);
+    cout << "online:\t" << party << "\t" << time_from(t1) << endl;
+    return out;
+}
+
+std::vector<bool> evaluate_plain(const BristolFormat& cf, const std::vector<bool>& in) {
+    std::vector<bool> wires(cf.num_wire);
+    std::copy(in.begin(), in.end(), wires.begin());
+    for (int i = 0; i < cf.num_gate; ++i) {
+        const int* g = &cf.gates[4*i];
+        if (g[3] == AND_GATE) wires[g[2]] = wires[g[0]] and wires[g[1]];
+        else if (g[3] == XOR_GATE) wires[g[2]] = wires[g[0]] != wires[g[1]];
+        else wires[g[2]] = !wires[g[0]];
+    }
+    return std::vector<bool>(wires.end() - cf.n3, wires.end());
+}
+
+bool check_sha1(const std::vector<bool>& out) {
+    string res = "";
+    for (int i = 0; i < out.size(); ++i)
+        res += (out[i] ? "1" : "0");
+    cout << res << endl;
+    cout << binary_to_hex(res) << endl;
+    cout << sha1_empty << endl;
+    return binary_to_hex(res) == string(sha1_empty);
+}
+
 int main(int argc, char** argv) {
     int port, party;
     parse_party_and_port(argv, &party, &port);
@@ -24,19 +64,6 @@ int main(int argc, char** argv) {
     string file = circuit_file_location;
 
     BristolFormat cf(file.c_str());
-    auto t1 = clock_start();
-    C2PC twopc(io, party, &cf);
-    io.flush();
-    cout << "one time:\t" << party << "\t" << time_from(t1) << endl;
-    t1 = clock_start();
-    twopc.function_independent();
-    io.flush();
-    cout << "inde:\t" << party << "\t" << time_from(t1) << endl;
-
-    t1 = clock_start();
-    twopc.function_dependent();
-    io.flush();
-    cout << "dep:\t" << party << "\t" << time_from(t1) << endl;
 
     int input_size = party == ALICE ? 512 : 0;
     std::vector<bool> in(input_size);
@@ -52,17 +79,186 @@ int main(int argc, char** argv) {
         // ^ 512 input bits from Alice
     }
 
-    t1 = clock_start();
-    std::vector<bool> out = twopc.online(in, true);
-    cout << "online:\t" << party << "\t" << time_from(t1) << endl;
+    // both table layouts must give the same result; the row-reduced one
+    // should send fewer bytes
+    bool all_good = true;
+    TableMode modes[2] = {TableMode::FULL, TableMode::ROW_REDUCED};
+    const char * mode_names[2] = {"full", "row-reduced"};
+    for (int m = 0; m < 2; ++m) {
+        cout << "mode:\t" << mode_names[m] << endl;
+        uint64_t sent_before = *io.counter;
 
-    string res = "";
-    for (int i = 0; i < out.size(); ++i)
-        res += (out[i] ? "1" : "0");
-    cout << res << endl;
-    cout << binary_to_hex(res) << endl;
-    cout << sha1_empty << endl;
-    cout << (binary_to_hex(res) == string(sha1_empty) ? "GOOD!" : "BAD!") << endl;
+        auto t1 = clock_start();
+        C2PC twopc(io, party, &cf, 40, modes[m]);
+        // the row-reduced run also keeps BOB's tables in a spill file
+        if (modes[m] == TableMode::ROW_REDUCED)
+            twopc.spill_threshold = 0;
+        io.flush();
+        cout << "one time:\t" << party << "\t" << time_from(t1) << endl;
+
+        std::vector<bool> out = run(twopc, io, party, in);
+        cout << "sent:\t" << party << "\t" << (*io.counter - sent_before) << endl;
+        all_good = check_sha1(out) and all_good;
+    }
+
+    // back-to-back circuits on one long-lived Fpre: the adder refills
+    // in function_independent, sha-1 uses triples refilled ahead of time
+    cout << "shared fpre" << endl;
+    BristolFormat adder("circuits/adder_32bit.txt");
+    Fpre fpre(io, party, 1000);
+
+    {
+        C2PC twopc(io, party, &adder, &fpre);
+        std::vector<bool> adder_in(32);
+        int x = party == ALICE ? 3 : 5;
+        for (int i = 0; i < 32; ++i)
+            adder_in[i] = (x >> i) & 1;
+        std::vector<bool> out = run(twopc, io, party, adder_in);
+        int sum = 0;
+        for (int i = 0; i < 32; ++i)
+            sum |= out[i] << i;
+        cout << "3 + 5 = " << sum << endl;
+        all_good = all_good and sum == 8;
+    }
+
+    {
+        // ALICE only learns the low half of the sum, BOB the high half
+        C2PC twopc(io, party, &adder, &fpre);
+        std::vector<bool> adder_in(32);
+        int x = party == ALICE ? 1000 : 70000;
+        for (int i = 0; i < 32; ++i)
+            adder_in[i] = (x >> i) & 1;
+        std::vector<int> output_party(adder.n3, BOB);
+        for (int i = 0; i < 16; ++i)
+            output_party[i] = ALICE;
+        std::vector<bool> out = run(twopc, io, party, adder_in, &output_party);
+        int sum = 0;
+        for (int i = 0; i < 32; ++i)
+            sum |= out[i] << i;
+        cout << "1000 + 70000 = " << sum << " (own half)" << endl;
+        all_good = all_good and sum == (party == ALICE ? (71000 & 0xFFFF) : (71000 & ~0xFFFF));
+    }
+
+    {
+        // a generated circuit, after a trip through the binary layout
+        SyntheticCircuitSpec spec;
+        spec.num_and = 2000;
+        spec.width = 100;
+        spec.xor_ratio = 2;
+        BristolFormat generated = synthetic_circuit(spec);
+        std::vector<uint8_t> buf = generated.to_buffer();
+        BristolFormat synthetic;
+        synthetic.from_buffer(buf.data(), buf.size());
+        all_good = all_good and synthetic.gates == generated.gates;
+
+        std::vector<bool> both_in(synthetic.n1 + synthetic.n2);
+        for (size_t i = 0; i < both_in.size(); ++i)
+            both_in[i] = i % 3 == 0;
+        std::vector<bool> own_in = party == ALICE
+            ? std::vector<bool>(both_in.begin(), both_in.begin() + synthetic.n1)
+            : std::vector<bool>(both_in.begin() + synthetic.n1, both_in.end());
+
+        C2PC twopc(io, party, &synthetic, &fpre);
+        bool match = run(twopc, io, party, own_in) == evaluate_plain(synthetic, both_in);
+        cout << "synthetic:\t" << (match ? "match" : "mismatch") << endl;
+        all_good = all_good and match;
+    }
+
+    {
+        // the adder again over a simulated 5 ms link next to the loopback one
+        WANConfig wan;
+        wan.latency_ms = 5;
+        wan.jitter_ms = 2;
+        wan.bandwidth = 10e6;
+        IOChannel slow_io(std::make_shared<SimulatedWAN>(
+            std::make_shared<NetIO>(party == ALICE ? nullptr : IP, port + 1), wan));
+        C2PC twopc(slow_io, party, &adder, 40);
+        std::vector<bool> adder_in(32);
+        int x = party == ALICE ? 3 : 5;
+        for (int i = 0; i < 32; ++i)
+            adder_in[i] = (x >> i) & 1;
+        uint64_t rounds_before = *slow_io.rounds;
+        auto t1 = clock_start();
+        std::vector<bool> out = run(twopc, slow_io, party, adder_in);
+        double ms = time_from(t1) / 1000;
+        uint64_t rounds = *slow_io.rounds - rounds_before;
+        int sum = 0;
+        for (int i = 0; i < 32; ++i)
+            sum |= out[i] << i;
+        cout << "wan:\t" << party << "\t" << rounds << " rounds, " << ms << " ms" << endl;
+        // a reply cannot go out before the message it answers has arrived
+        all_good = all_good and sum == 8 and ms >= rounds * wan.latency_ms / 2;
+    }
+
+    {
+        // every phase reports its start and its end, function_independent
+        // also from inside the Fpre refill
+        std::vector<std::tuple<string, int64_t, int64_t>> updates;
+        Progress::get().set_handler([&](const char* phase, int64_t done, int64_t total) {
+            updates.emplace_back(phase, done, total);
+        }, 0);
+        C2PC twopc(io, party, &adder, 40);
+        std::vector<bool> adder_in(32);
+        run(twopc, io, party, adder_in);
+        Progress::get().set_handler(nullptr);
+
+        int refill_updates = 0;
+        for (auto& u : updates)
+            if (std::get<0>(u) == "function_independent" and std::get<1>(u) > 0
+                    and std::get<1>(u) < std::get<2>(u))
+                ++refill_updates;
+        bool ok = updates.size() >= 6 and refill_updates > 0;
+        for (const char* phase : {"function_independent", "function_dependent", "online"}) {
+            std::vector<std::tuple<string, int64_t, int64_t>> p;
+            for (auto& u : updates)
+                if (std::get<0>(u) == phase)
+                    p.push_back(u);
+            ok = ok and !p.empty() and std::get<1>(p.front()) == 0
+                and std::get<1>(p.back()) == std::get<2>(p.back());
+            // one unit per phase: the total never changes and done only grows
+            for (size_t i = 1; i < p.size(); ++i)
+                ok = ok and std::get<2>(p[i]) == std::get<2>(p[0])
+                    and std::get<1>(p[i]) >= std::get<1>(p[i-1]);
+        }
+        cout << "progress:\t" << party << "\t" << updates.size() << " updates" << endl;
+        all_good = all_good and ok;
+    }
+
+    {
+        // the tagged buffers are counted while the run lasts and released
+        // with it
+        MemAccount& mem = MemAccount::get();
+        int64_t live_before = mem.live();
+        mem.reset();
+        int64_t tables = 0;
+        {
+            C2PC twopc(io, party, &adder, 40);
+            std::vector<bool> adder_in(32);
+            twopc.function_independent();
+            twopc.function_dependent();
+            tables = twopc.GT_buf.bytes() + twopc.GTK_buf.bytes() + twopc.GTM_buf.bytes();
+            twopc.online(adder_in, true);
+        }
+        bool ok = mem.live() == live_before and mem.peak() >= live_before + tables
+            and mem.peak() > live_before;
+        cout << "memory:\t" << party << "\t" << mem.to_json() << endl;
+        all_good = all_good and ok;
+    }
+
+    int num_ands = 0;
+    for (int i = 0; i < cf.num_gate; ++i)
+        if (cf.gates[4*i+3] == AND_GATE)
+            ++num_ands;
+    auto t1 = clock_start();
+    fpre.set_batch_size(num_ands);
+    fpre.refill();
+    cout << "refill:\t" << party << "\t" << time_from(t1) << endl;
+
+    {
+        C2PC twopc(io, party, &cf, &fpre);
+        all_good = check_sha1(run(twopc, io, party, in)) and all_good;
+    }
+    cout << (all_good ? "GOOD!" : "BAD!") << endl;
 
     return 0;
 }
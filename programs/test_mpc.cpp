@@ -10,7 +10,12 @@ int main(int argc, char** argv) {
     int port, party;
     parse_party_and_port(argv, &party, &port);
 
-    const static int nP = 4;
+    // optional third argument: number of parties (2..8, default 4)
+    int nP = argc > 3 ? atoi(argv[3]) : 4;
+    if (nP < 2 || nP > 8) {
+        cerr << "number of parties must be between 2 and 8" << endl;
+        return 1;
+    }
     std::shared_ptr<IMultiIO> io = std::make_shared<NetIOMP>(nP, party, port);
     BristolFormat cf(circuit_file_location.c_str());
 
@@ -0,0 +1,88 @@
+#include <sstream>
+#include <emp-tool/emp-tool.h>
+#include "emp-agmpc/emp-agmpc.h"
+using namespace std;
+using namespace emp;
+
+const string circuit_file_location = "circuits/sha-1.txt";
+const string sha1_empty = "da39a3ee5e6b4b0d3255bfef95601890afd80709";
+const static int runs = 3;
+
+bool run_sha1(std::shared_ptr<IMultiIO>& io, BristolFormat& cf, PreprocessPool& pool, int nP, int party, int evaluator, int64_t spill_threshold, bool split_output) {
+    auto start = clock_start();
+    CMPC* mpc = new CMPC(io, &cf, &pool, evaluator);
+    mpc->spill_threshold = spill_threshold;
+    mpc->function_independent();
+    mpc->function_dependent();
+
+    FlexIn input(nP, cf.n1 + cf.n2, party);
+    for (int i = 0; i < cf.n1 + cf.n2; i++) {
+        input.assign_party(i, 1);
+        if (party == 1)
+            input.assign_plaintext_bit(i, i == 0);
+    }
+
+    // split_output gives each party one group of the output bits, otherwise
+    // every bit stays with party 0, i.e. everyone
+    FlexOut output(nP, cf.n3, party);
+    vector<int> groups(nP, cf.n3 / nP);
+    groups[0] += cf.n3 % nP;
+    if (split_output)
+        output.assign_groups(groups);
+
+    mpc->online(&input, &output);
+    cout <<"RUN:\t"<<party<<"\tevaluator "<<evaluator<<"\t"<<time_from(start)<<" us\n";
+
+    string res = "", expected = hex_to_binary(sha1_empty);
+    if (split_output) {
+        int first = 0;
+        for (int p = 1; p < party; ++p)
+            first += groups[p-1];
+        expected = expected.substr(first, groups[party-1]);
+        for (int i = first; i < first + groups[party-1]; ++i)
+            res += (output.get_plaintext_bit(i)?"1":"0");
+    } else {
+        for(int i = 0; i < cf.n3; ++i)
+            res += (output.get_plaintext_bit(i)?"1":"0");
+    }
+    delete mpc;
+    return res == expected;
+}
+
+int main(int argc, char** argv) {
+    int port, party;
+    parse_party_and_port(argv, &party, &port);
+
+    const static int nP = 3;
+    std::shared_ptr<IMultiIO> io = std::make_shared<NetIOMP>(nP, party, port);
+    BristolFormat cf(circuit_file_location.c_str());
+
+    int num_ands = 0;
+    for(int i = 0; i < cf.num_gate; ++i)
+        if (cf.gates[4*i+3] == AND_GATE)
+            ++num_ands;
+
+    // idle time: preprocess enough for several runs, then round-trip the
+    // pool through its serialized form
+    auto start = clock_start();
+    stringstream stored;
+    {
+        PreprocessPool pool;
+        pool.generate(io, runs * num_ands, runs * (cf.n1 + cf.n2 + num_ands));
+        pool.save(stored);
+    }
+    cout <<"POOL:\t"<<party<<"\t"<<time_from(start)<<" us\n";
+
+    PreprocessPool pool;
+    pool.load(stored);
+
+    // rotate the evaluator role between runs; every other run keeps the
+    // evaluator's tables in a spill file, and the last one splits the output
+    // between the parties
+    bool good = true;
+    for(int i = 0; i < runs; ++i)
+        good = run_sha1(io, cf, pool, nP, party, 1 + i % nP, i % 2 ? 0 : -1, i == runs - 1) and good;
+
+    cout << (good and pool.ands_left() == 0? "GOOD!":"BAD!")<<endl<<flush;
+    return 0;
+}
@@ -0,0 +1,42 @@
+#!/bin/bash
+
+set -euo pipefail
+
+# Usage: ./scripts/bench.sh [circuit files..., default circuits/*.txt] > bench.json
+#
+# Runs each circuit in 2pc mode and in mpc mode with 2 to $MAX_PARTIES
+# parties (default 4), and prints the results as one JSON array. Other
+# circuits (AES, sorting networks, ...) can be passed in Bristol format.
+# SYNTHETIC="1000 100000" adds generated circuits with those AND counts
+# (needs ./scripts/build_gen_circuit.sh).
+# WAN_LATENCY_MS, WAN_BANDWIDTH, WAN_JITTER_MS and WAN_SEED are passed on to
+# ./build/bench to simulate a slower network.
+# Build first with ./scripts/build_bench.sh.
+MAX_PARTIES=${MAX_PARTIES:-4}
+PORT=${PORT:-12345}
+
+if [ $# -eq 0 ]; then
+  set -- circuits/*.txt
+fi
+
+for ANDS in ${SYNTHETIC:-}; do
+  ./build/gen_circuit --binary ands=$ANDS width=1000 > build/synthetic_$ANDS.bin
+  set -- "$@" build/synthetic_$ANDS.bin
+done
+
+SEP=""
+echo "["
+for CIRCUIT in "$@"; do
+  RUNS=("2pc 2")
+  for ((NP = 2; NP <= MAX_PARTIES; NP++)); do
+    RUNS+=("mpc $NP")
+  done
+
+  for RUN in "${RUNS[@]}"; do
+    # fresh ports for each run, so lingering sockets don't get in the way
+    PORT=$((PORT + 100))
+    echo "$SEP$(./build/bench "$CIRCUIT" $RUN $PORT)"
+    SEP=","
+  done
+done
+echo "]"
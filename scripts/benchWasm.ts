@@ -0,0 +1,164 @@
+// tsx scripts/benchWasm.ts [--circuit circuits/sha-1.txt] [--parties 3]
+//   [--mode mpc] [--latency 0] [--bandwidth 0] [--jitter 0] [--seed 1] [--runs 1]
+//
+// Runs every party of a circuit in this process, each in its own instance of
+// the Wasm module (build it first with `npm run build`), wired together by
+// in-memory channels. --latency (ms, one way) and --bandwidth (bytes/s per
+// direction, 0 for unlimited) delay delivery on every link, and --jitter (ms)
+// adds a random delay drawn from --seed, see SimulatedLinkIO. Prints JSON with
+// each party's time and Wasm heap size at the end of each phase, and the
+// bytes sent on each channel.
+
+import fs from 'fs/promises';
+
+import BufferQueue from '../src/ts/BufferQueue';
+import bristolToBinary from '../src/ts/bristolToBinary';
+import nodeSecureMPC from '../src/ts/nodeSecureMPC';
+import SimulatedLinkIO from '../src/ts/SimulatedLinkIO';
+import type { IO } from '../src/ts/types';
+
+type Options = {
+  circuit: string,
+  parties: number,
+  mode: '2pc' | 'mpc',
+  latency: number,
+  bandwidth: number,
+  jitter: number,
+  seed: number,
+  runs: number,
+};
+
+type PhaseReport = { phase: string, ms: number, heapBytes: number };
+
+async function main() {
+  const options = parseArgs(process.argv.slice(2));
+  const circuitBinary = bristolToBinary(await fs.readFile(options.circuit, 'utf-8'));
+  const results = [];
+
+  for (let run = 0; run < options.runs; run++) {
+    results.push(await benchOnce(options, circuitBinary));
+  }
+
+  console.log(JSON.stringify({ ...options, results }, null, 2));
+}
+
+async function benchOnce(options: Options, circuitBinary: Uint8Array) {
+  const { parties } = options;
+  const view = new DataView(circuitBinary.buffer, circuitBinary.byteOffset);
+  const [n1, n2] = [view.getUint32(8, true), view.getUint32(12, true)];
+
+  // n1 bits from party 0 and n2 from party 1, like the native bench
+  const inputBitsPerParty = Array.from({ length: parties }, (_, i) => [n1, n2][i] ?? 0);
+
+  const links = new Links();
+  const phases: PhaseReport[][] = Array.from({ length: parties }, () => []);
+  const heapBefore = process.memoryUsage().heapUsed;
+  const start = performance.now();
+
+  await Promise.all(Array.from({ length: parties }, (_, party) => nodeSecureMPC({
+    party,
+    size: parties,
+    circuitBinary,
+    inputBits: new Uint8Array(inputBitsPerParty[party]),
+    inputBitsPerParty,
+    io: new SimulatedLinkIO(links.io(party), { ...options, seed: options.seed + party }),
+    mode: options.mode,
+    onPhase: (phase, heapBytes) => {
+      phases[party].push({ phase, ms: performance.now() - start, heapBytes });
+    },
+  })));
+
+  return {
+    totalMs: performance.now() - start,
+    jsHeapGrowth: process.memoryUsage().heapUsed - heapBefore,
+    parties: phases.map((p, party) => ({ party, phases: p })),
+    channels: links.bytes(),
+  };
+}
+
+/** In-memory channels between all parties, counting the bytes on each. */
+class Links {
+  private queues = new Map<string, BufferQueue>();
+  private sent = new Map<string, number>();
+
+  io(party: number): IO {
+    return {
+      send: (toParty, channel, data) => {
+        const key = `${party}->${toParty}:${channel}`;
+        this.sent.set(key, (this.sent.get(key) ?? 0) + data.length);
+        this.queue(key).push(data);
+      },
+      recv: (fromParty, channel, minLen, maxLen) =>
+        this.queue(`${fromParty}->${party}:${channel}`).pop(minLen, maxLen),
+    };
+  }
+
+  bytes() {
+    return Object.fromEntries(this.sent);
+  }
+
+  private queue(key: string) {
+    let q = this.queues.get(key);
+
+    if (q === undefined) {
+      q = new BufferQueue();
+      this.queues.set(key, q);
+    }
+
+    return q;
+  }
+}
+
+function parseArgs(args: string[]): Options {
+  const options: Options = {
+    circuit: 'circuits/sha-1.txt',
+    parties: 3,
+    mode: 'mpc',
+    latency: 0,
+    bandwidth: 0,
+    jitter: 0,
+    seed: 1,
+    runs: 1,
+  };
+
+  for (let i = 0; i < args.length; i += 2) {
+    const [flag, value] = [args[i], args[i + 1]];
+
+    if (value === undefined) {
+      throw new Error(`Missing value for ${flag}`);
+    }
+
+    switch (flag) {
+      case '--circuit':
+        options.circuit = value;
+        break;
+      case '--mode':
+        if (value !== '2pc' && value !== 'mpc') {
+          throw new Error('--mode must be 2pc or mpc');
+        }
+        options.mode = value;
+        break;
+      case '--parties':
+      case '--latency':
+      case '--bandwidth':
+      case '--jitter':
+      case '--seed':
+      case '--runs':
+        options[flag.slice(2) as 'parties' | 'latency' | 'bandwidth' | 'jitter' | 'seed' | 'runs'] = Number(value);
+        break;
+      default:
+        throw new Error(`Unknown flag ${flag}`);
+    }
+  }
+
+  if (options.mode === '2pc' && options.parties !== 2) {
+    throw new Error('2pc mode needs 2 parties');
+  }
+
+  return options;
+}
+
+main().catch(error => {
+  console.error(error);
+  process.exit(1);
+});
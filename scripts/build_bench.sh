@@ -0,0 +1,19 @@
+#!/bin/bash
+
+set -euo pipefail
+
+# No -D__debug here, the numbers should match a release build
+clang++ \
+    -O3 \
+    -std=c++17 \
+    -pthread \
+    programs/bench.cpp \
+    -I src/cpp \
+    -I $(brew --prefix mbedtls)/include \
+    -L $(brew --prefix mbedtls)/lib \
+    -lmbedtls \
+    -lmbedcrypto \
+    -lmbedx509 \
+    -o build/bench
+
+echo "Build successful, use ./scripts/bench.sh to run the benchmarks."
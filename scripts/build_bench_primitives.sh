@@ -0,0 +1,43 @@
+#!/bin/bash
+
+set -euo pipefail
+
+# Usage: ./scripts/build_bench_primitives.sh [wasm]
+#
+# Without arguments, builds build/bench_primitives for this machine. With
+# `wasm`, builds build/bench_primitives.js with emscripten (after
+# ./scripts/build_mbedtls.sh), to be run with `node build/bench_primitives.js`.
+mkdir -p build
+
+if [ "${1:-}" == "wasm" ]; then
+  MBEDTLS_DIR="./external/mbedtls"
+
+  em++ programs/bench_primitives.cpp -o build/bench_primitives.js \
+    -O3 \
+    -std=c++17 \
+    -I ./src/cpp/ \
+    -I "$MBEDTLS_DIR/include" \
+    -L "$MBEDTLS_DIR/build/library" \
+    -lmbedtls \
+    -lmbedcrypto \
+    -lmbedx509 \
+    -sALLOW_MEMORY_GROWTH \
+    -sNO_DISABLE_EXCEPTION_CATCHING \
+    -s ENVIRONMENT='node'
+
+  echo "Build successful, use node build/bench_primitives.js to run the benchmarks."
+else
+  clang++ \
+    -O3 \
+    -std=c++17 \
+    programs/bench_primitives.cpp \
+    -I src/cpp \
+    -I $(brew --prefix mbedtls)/include \
+    -L $(brew --prefix mbedtls)/lib \
+    -lmbedtls \
+    -lmbedcrypto \
+    -lmbedx509 \
+    -o build/bench_primitives
+
+  echo "Build successful, use ./build/bench_primitives to run the benchmarks."
+fi
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+set -euo pipefail
+
+clang++ \
+    -O3 \
+    -std=c++17 \
+    programs/gen_circuit.cpp \
+    -I src/cpp \
+    -I $(brew --prefix mbedtls)/include \
+    -L $(brew --prefix mbedtls)/lib \
+    -lmbedtls \
+    -lmbedcrypto \
+    -lmbedx509 \
+    -o build/gen_circuit
+
+echo "Build successful, use ./build/gen_circuit to generate circuits."
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+set -euo pipefail
+
+# Note: -D__debug does not seem to impact performance, and is good for testing
+clang++ \
+    -O3 \
+    -std=c++17 \
+    -pthread \
+    -D__debug \
+    programs/test_mpc_pool.cpp \
+    -I src/cpp \
+    -I $(brew --prefix mbedtls)/include \
+    -L $(brew --prefix mbedtls)/lib \
+    -lmbedtls \
+    -lmbedcrypto \
+    -lmbedx509 \
+    -o build/mpc_pool
+
+echo "Build successful, use ./scripts/mpc_pool_test.sh to run the program."
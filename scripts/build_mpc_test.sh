@@ -6,6 +6,7 @@ set -euo pipefail
 clang++ \
     -O3 \
     -std=c++17 \
+    -pthread \
     -D__debug \
     programs/test_mpc.cpp \
     -I src/cpp \
@@ -48,7 +48,7 @@ em++ programs/jslib.cpp -sASYNCIFY -o build/jslib.js \
   -sSTACK_SIZE=8388608 \
   -sASYNCIFY_STACK_SIZE=16384 \
   -sEXPORTED_FUNCTIONS=['_js_malloc','_main'] \
-  -sEXPORTED_RUNTIME_METHODS=['HEAPU8','setValue'] \
+  -sEXPORTED_RUNTIME_METHODS=['HEAPU8','setValue','UTF8ToString'] \
   -s MODULARIZE=1 \
   -s EXPORT_ES6=1 \
   -s EXPORT_NAME=createModule
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+set -euo pipefail
+
+# Runs the sha-1 MPC test for 2 to 8 parties and prints the bytes sent by
+# the evaluator (party 1) and by all parties together.
+# Build first with ./scripts/build_mpc_test.sh.
+for NP in 2 3 4 5 6 7 8; do
+  OUT=$(./scripts/mpc_test.sh $NP)
+  if [ $(echo "$OUT" | grep -c "GOOD!") -ne $NP ]; then
+    echo "$OUT"
+    exit 1
+  fi
+  EVAL=$(echo "$OUT" | grep "^A: bandwidth" | awk '{print $NF}')
+  TOTAL=$(echo "$OUT" | grep "bandwidth" | awk '{s += $NF} END {print s}')
+  echo -e "parties\t$NP\tevaluator sent\t$EVAL\ttotal sent\t$TOTAL"
+done
@@ -2,34 +2,28 @@
 
 set -euo pipefail
 
-# Define the programs to run
-PROGRAM_A="./build/mpc 1 8005"
-PROGRAM_B="./build/mpc 2 8005"
-PROGRAM_C="./build/mpc 3 8005"
-PROGRAM_D="./build/mpc 4 8005"
+# Usage: ./scripts/mpc_test.sh [number of parties, default 4]
+NP=${1:-4}
+NAMES=(A B C D E F G H)
 
-# Run 3 instances of the program in the background and print output as it comes
-$PROGRAM_A 2>&1 | sed 's/^/A: /' &
-PID1=$!
-$PROGRAM_B 2>&1 | sed 's/^/B: /' &
-PID2=$!
-$PROGRAM_C 2>&1 | sed 's/^/C: /' &
-PID3=$!
-$PROGRAM_D 2>&1 | sed 's/^/D: /' &
-PID4=$!
+# Run one instance of the program per party in the background and print output as it comes
+PIDS=()
+for ((i = 1; i <= NP; i++)); do
+  ./build/mpc $i 8005 $NP 2>&1 | sed "s/^/${NAMES[$((i-1))]}: /" &
+  PIDS+=($!)
+done
 
 # Function to abort everything if a process fails
 abort() {
   echo "Aborting..."
-  kill $PID1 $PID2 $PID3 $PID4 2>/dev/null
-  wait $PID1 $PID2 $PID3 $PID4 2>/dev/null
+  kill "${PIDS[@]}" 2>/dev/null
+  wait "${PIDS[@]}" 2>/dev/null
   exit 1
 }
 
 # Wait for all processes to complete, abort if any fail
-wait $PID1 || abort
-wait $PID2 || abort
-wait $PID3 || abort
-wait $PID4 || abort
+for PID in "${PIDS[@]}"; do
+  wait $PID || abort
+done
 
 echo "Finished"
@@ -7,11 +7,22 @@
 
 namespace emp {
 
+// Layout of the AND gate tables sent by ALICE. FULL sends four rows of a
+// partial MAC block plus a label block. ROW_REDUCED derives each AND output
+// label from the row-0 hash so that row 0's label block is zero and is not
+// sent (GRR3), saving 16 bytes per AND gate. Both parties must agree.
+enum class TableMode { FULL, ROW_REDUCED };
+
 class C2PC {
 public:
     const static int SSP = 5;//5*8 in fact...
+    const static int PUBLIC = 0; // an output both parties learn
     const block MASK = makeBlock(0x0ULL, 0xFFFFFULL);
     Fpre* fpre = nullptr;
+    bool own_fpre = true;
+    // mac, key, preprocess_*, sigma_* and labels, in one uninitialised
+    // allocation
+    AlignedBuffer<block> blocks;
     block * mac = nullptr;
     block * key = nullptr;
 
@@ -24,60 +35,90 @@ public:
     block * labels = nullptr;
 
     bool * mask = nullptr;
+    // the arrays above, in MemAccount
+    MemTag wires_mem{"C2PC::wires"};
+    MemTag preprocess_mem{"C2PC::preprocess"};
+    MemTag sigma_mem{"C2PC::sigma"};
     BristolFormat * cf;
     IOChannel io;
     int num_ands = 0;
     int party, total_pre;
 
     int input_size;
+    TableMode mode;
+
+    C2PC(IOChannel io, int party, BristolFormat* cf, int ssp = 40, TableMode mode = TableMode::FULL)
+    :
+        io(io), mode(mode)
+    {
+        this->party = party;
+        this->cf = cf;
+        init();
+        fpre = new Fpre(io, party, num_ands, ssp);
+    }
 
-    C2PC(IOChannel io, int party, BristolFormat* cf)
+    // Runs on a long-lived Fpre owned by the caller, so base OTs and the
+    // LeakyDeltaOT setup (and Delta) are shared by every circuit run on it.
+    // Triples the Fpre already holds are used if there are enough of them;
+    // the caller may refill it for the next circuit once function_dependent
+    // of the current one has returned.
+    C2PC(IOChannel io, int party, BristolFormat* cf, Fpre* fpre, TableMode mode = TableMode::FULL)
     :
-        io(io)
+        io(io), mode(mode)
     {
+        if(fpre->party != party)
+            error("Fpre belongs to the other party");
         this->party = party;
         this->cf = cf;
+        this->fpre = fpre;
+        own_fpre = false;
+        init();
+        if(!fpre->ready or fpre->batch_size < num_ands)
+            fpre->set_batch_size(num_ands);
+    }
+
+    void init() {
         for(int i = 0; i < cf->num_gate; ++i) {
             if (cf->gates[4*i+3] == AND_GATE)
                 ++num_ands;
         }
         // cout << cf->n1<<" "<<cf->n2<<" "<<cf->n3<<" "<<num_ands<<"\n";
         total_pre = cf->n1 + cf->n2 + num_ands;
-        fpre = new Fpre(io, party, num_ands);
 
-        key = new block[cf->num_wire];
-        mac = new block[cf->num_wire];
+        blocks = AlignedBuffer<block>(3 * cf->num_wire + 2 * total_pre + 2 * num_ands, BufferInit::UNINITIALIZED);
+        block * next = blocks.data();
+        auto carve = [&](size_t n) { block * p = next; next += n; return p; };
+
+        key = carve(cf->num_wire);
+        mac = carve(cf->num_wire);
 
-        preprocess_mac = new block[total_pre];
-        preprocess_key = new block[total_pre];
+        preprocess_mac = carve(total_pre);
+        preprocess_key = carve(total_pre);
 
         //sigma values in the paper
-        sigma_mac = new block[num_ands];
-        sigma_key = new block[num_ands];
+        sigma_mac = carve(num_ands);
+        sigma_key = carve(num_ands);
 
-        labels = new block[cf->num_wire];
+        labels = carve(cf->num_wire);
 
         mask = new bool[cf->n1 + cf->n2];
+
+        wires_mem.set(3 * cf->num_wire * sizeof(block) + cf->n1 + cf->n2);
+        preprocess_mem.set(2 * total_pre * sizeof(block));
+        sigma_mem.set(2 * num_ands * sizeof(block));
     }
     ~C2PC(){
-        delete[] key;
-        delete[] mac;
         delete[] mask;
-        delete[] GT;
-        delete[] GTK;
-        delete[] GTM;
-
-        delete[] preprocess_mac;
-        delete[] preprocess_key;
-
-        delete[] sigma_mac;
-        delete[] sigma_key;
-
-        delete[] labels;
-        delete fpre;
+        if(own_fpre)
+            delete fpre;
     }
     PRG prg;
     PRP prp;
+    // BOB's tables, kept until online. Any of them larger than
+    // spill_threshold bytes is spilled to a temporary file (native only);
+    // -1 keeps them all in memory.
+    int64_t spill_threshold = -1;
+    SpillBuffer<block> GT_buf{"C2PC::GT"}, GTK_buf{"C2PC::GTK"}, GTM_buf{"C2PC::GTM"};
     block (* GT)[4][2] = nullptr;
     block (* GTK)[4] = nullptr;
     block (* GTM)[4] = nullptr;
@@ -86,10 +127,17 @@ public:
     block * ANDS_mac = nullptr;
     block * ANDS_key = nullptr;
     void function_independent() {
+        TRACE_SCOPE("C2PC::function_independent");
+        report_progress("function_independent", 0, num_ands);
         if(party == ALICE)
             prg.random_block(labels, cf->num_wire);
 
-        fpre->refill();
+        if(!fpre->ready) {
+            fpre->progress_total = num_ands;
+            fpre->refill();
+            fpre->progress_total = 0;
+        }
+        fpre->ready = false; // the triples now belong to this circuit
         ANDS_mac = fpre->MAC_res;
         ANDS_key = fpre->KEY_res;
 
@@ -102,9 +150,11 @@ public:
         }
         memcpy(key, preprocess_key, (cf->n1+cf->n2)*sizeof(block));
         memcpy(mac, preprocess_mac, (cf->n1+cf->n2)*sizeof(block));
+        report_progress("function_independent", num_ands, num_ands);
     }
 
     void function_dependent() {
+        TRACE_SCOPE("C2PC::function_dependent");
         int ands = cf->n1+cf->n2;
         bool * x1 = new bool[num_ands];
         bool * y1 = new bool[num_ands];
@@ -119,14 +169,17 @@ public:
             }
         }
 
+        // with ROW_REDUCED, AND output labels are only known while garbling,
+        // so ALICE propagates labels in the garbling pass below instead
+        bool labels_here = (party == ALICE and mode == TableMode::FULL);
         for(int i = 0; i < cf->num_gate; ++i) {
             if (cf->gates[4*i+3] == XOR_GATE) {
                 key[cf->gates[4*i+2]] = key[cf->gates[4*i]] ^ key[cf->gates[4*i+1]];
                 mac[cf->gates[4*i+2]] = mac[cf->gates[4*i]] ^ mac[cf->gates[4*i+1]];
-                if(party == ALICE)
+                if(labels_here)
                     labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ labels[cf->gates[4*i+1]];
             } else if (cf->gates[4*i+3] == NOT_GATE) {
-                if(party == ALICE)
+                if(labels_here)
                     labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ fpre->Delta;
                 key[cf->gates[4*i+2]] = key[cf->gates[4*i]];
                 mac[cf->gates[4*i+2]] = mac[cf->gates[4*i]];
@@ -182,18 +235,29 @@ public:
             }
         }//sigma_[] stores the and of input wires to each AND gates
 
-        delete[] fpre->MAC;
-        delete[] fpre->KEY;
-        fpre->MAC = nullptr;
-        fpre->KEY = nullptr;
-        GT = new block[num_ands][4][2];
-        GTK = new block[num_ands][4];
-        GTM = new block[num_ands][4];
+        fpre->release_window_buffers();
+        if(party == BOB) {
+            GT_buf.alloc((size_t)num_ands*4*2, spill_threshold);
+            GTK_buf.alloc((size_t)num_ands*4, spill_threshold);
+            GTM_buf.alloc((size_t)num_ands*4, spill_threshold);
+            GT = reinterpret_cast<block(*)[4][2]>(GT_buf.data());
+            GTK = reinterpret_cast<block(*)[4]>(GTK_buf.data());
+            GTM = reinterpret_cast<block(*)[4]>(GTM_buf.data());
+        }
 
+        TraceSpan garble_span("C2PC::garble");
         ands = 0;
         block H[4][2];
         block K[4], M[4];
+        bool row_reduced = (mode == TableMode::ROW_REDUCED);
         for(int i = 0; i < cf->num_gate; ++i) {
+            report_progress("function_dependent", i, cf->num_gate);
+            if(row_reduced and party == ALICE) {
+                if (cf->gates[4*i+3] == XOR_GATE)
+                    labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ labels[cf->gates[4*i+1]];
+                else if (cf->gates[4*i+3] == NOT_GATE)
+                    labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ fpre->Delta;
+            }
             if(cf->gates[4*i+3] == AND_GATE) {
                 M[0] = sigma_mac[ands] ^ mac[cf->gates[4*i+2]];
                 M[1] = M[0] ^ mac[cf->gates[4*i]];
@@ -211,6 +275,12 @@ public:
 
                 if(party == ALICE) {
                     Hash(H, labels[cf->gates[4*i]], labels[cf->gates[4*i+1]], i);
+                    if(row_reduced) {
+                        // pick the output label that zeroes row 0's label block
+                        labels[cf->gates[4*i+2]] = H[0][1] ^ K[0];
+                        if(getLSB(M[0]))
+                            labels[cf->gates[4*i+2]] = labels[cf->gates[4*i+2]] ^ fpre->Delta;
+                    }
                     for(int j = 0; j < 4; ++j) {
                         H[j][0] = H[j][0] ^ M[j];
                         H[j][1] = H[j][1] ^ K[j] ^ labels[cf->gates[4*i+2]];
@@ -222,7 +292,8 @@ public:
                     }
                     for(int j = 0; j < 4; ++j ) {
                         send_partial_block<SSP>(io, &H[j][0], 1);
-                        io.send_block(&H[j][1], 1);
+                        if(!row_reduced or j != 0)
+                            io.send_block(&H[j][1], 1);
                     }
                 } else {
                     memcpy(GTK[ands], K, sizeof(block)*4);
@@ -233,12 +304,16 @@ public:
 #endif
                     for(int j = 0; j < 4; ++j ) {
                         recv_partial_block<SSP>(io, &GT[ands][j][0], 1);
-                        io.recv_block(&GT[ands][j][1], 1);
+                        if(!row_reduced or j != 0)
+                            io.recv_block(&GT[ands][j][1], 1);
+                        else
+                            GT[ands][j][1] = zero_block;
                     }
                 }
                 ++ands;
             }
         }
+        garble_span.end();
         delete[] x1;
         delete[] x2;
         delete[] y1;
@@ -277,13 +352,33 @@ public:
             send_partial_block<SSP>(io, mac, cf->n1);
         }
         io.flush();
+        report_progress("function_dependent", cf->num_gate, cf->num_gate);
     }
 
     std::vector<bool> online(
         const std::vector<bool>& input,
         bool alice_output = false
     ) {
+        return online(input, std::vector<int>(cf->n3, alice_output ? PUBLIC : BOB));
+    }
+
+    // Who learns each output bit: PUBLIC (both parties), ALICE or BOB. Only
+    // the parties that learn a bit get what is needed to open it; the other
+    // party's entry in the result is false.
+    std::vector<bool> online(
+        const std::vector<bool>& input,
+        const std::vector<int>& output_party
+    ) {
+        TRACE_SCOPE("C2PC::online");
+        report_progress("online", 0, cf->num_gate);
+        if ((int)output_party.size() != cf->n3)
+            throw std::invalid_argument("output_party size does not match circuit");
+        for (int p : output_party)
+            if (p != PUBLIC and p != ALICE and p != BOB)
+                throw std::invalid_argument("output_party must be PUBLIC, ALICE or BOB");
+
         std::vector<bool> output(cf->n3);
+        int out_start = cf->num_wire - cf->n3;
 
         size_t correct_input_size = party == ALICE ? cf->n1 : cf->n2;
 
@@ -310,8 +405,10 @@ public:
                 if(mask_input[i]) tmp = tmp ^ fpre->Delta;
                 io.send_block(&tmp, 1);
             }
-            //send output mask data
-            send_partial_block<SSP>(io, mac+cf->num_wire - cf->n3, cf->n3);
+            //send output mask data for the bits BOB learns
+            for(int i = 0; i < cf->n3; ++i)
+                if(output_party[i] != ALICE)
+                    send_partial_block<SSP>(io, mac + out_start + i, 1);
         } else {
             for(int i = cf->n1; i < cf->n1+cf->n2; ++i) {
                 mask_input[i] = logic_xor(input[i-cf->n1], getLSB(mac[i]));
@@ -323,7 +420,9 @@ public:
         }
         int ands = 0;
         if(party == BOB) {
+            TRACE_SCOPE("C2PC::evaluate");
             for(int i = 0; i < cf->num_gate; ++i) {
+                report_progress("online", i, cf->num_gate);
                 if (cf->gates[4*i+3] == XOR_GATE) {
                     labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ labels[cf->gates[4*i+1]];
                     mask_input[cf->gates[4*i+2]] = logic_xor(mask_input[cf->gates[4*i]], mask_input[cf->gates[4*i+1]]);
@@ -355,73 +454,93 @@ public:
             }
         }
         if (party == BOB) {
-            bool * o = new bool[cf->n3];
+            std::vector<int> to_alice;
             for(int i = 0; i < cf->n3; ++i) {
+                if(output_party[i] != BOB)
+                    to_alice.push_back(i);
+                if(output_party[i] == ALICE)
+                    continue;
                 block tmp;
                 recv_partial_block<SSP>(io, &tmp, 1);
                 tmp =  tmp & MASK;
 
-                block ttt = key[cf->num_wire - cf-> n3 + i] ^ fpre->Delta;
+                block ttt = key[out_start + i] ^ fpre->Delta;
                 ttt =  ttt & MASK;
-                key[cf->num_wire - cf-> n3 + i] = key[cf->num_wire - cf-> n3 + i] & MASK;
+                block mask_key = key[out_start + i] & MASK;
 
-                if(cmpBlock(&tmp, &key[cf->num_wire - cf-> n3 + i], 1))
-                    o[i] = false;
+                bool o;
+                if(cmpBlock(&tmp, &mask_key, 1))
+                    o = false;
                 else if(cmpBlock(&tmp, &ttt, 1))
-                    o[i] = true;
+                    o = true;
                 else throw std::runtime_error("no match output label!");
+                output[i] = logic_xor(o, mask_input[out_start + i]);
+                output[i] = logic_xor(output[i], getLSB(mac[out_start + i]));
             }
-            for(int i = 0; i < cf->n3; ++i) {
-                output[i] = logic_xor(o[i], mask_input[cf->num_wire - cf->n3 + i]);
-                output[i] = logic_xor(output[i], getLSB(mac[cf->num_wire - cf->n3 + i]));
-            }
-            delete[] o;
-            if(alice_output) {
-                send_partial_block<SSP>(io, mac+cf->num_wire - cf->n3, cf->n3);
-                send_partial_block<SSP>(io, labels+cf->num_wire - cf->n3, cf->n3);
-                io.send_data(mask_input + cf->num_wire - cf->n3, cf->n3);
+            if(!to_alice.empty()) {
+                int n = to_alice.size();
+                block * tmp_mac = new block[n];
+                block * tmp_label = new block[n];
+                uint8_t * tmp_mask_input = new uint8_t[n];
+                for(int k = 0; k < n; ++k) {
+                    tmp_mac[k] = mac[out_start + to_alice[k]];
+                    tmp_label[k] = labels[out_start + to_alice[k]];
+                    tmp_mask_input[k] = mask_input[out_start + to_alice[k]];
+                }
+                send_partial_block<SSP>(io, tmp_mac, n);
+                send_partial_block<SSP>(io, tmp_label, n);
+                io.send_data(tmp_mask_input, n);
                 io.flush();
+                delete[] tmp_mac;
+                delete[] tmp_label;
+                delete[] tmp_mask_input;
             }
         } else {//ALICE
-            if(alice_output) {
-                block * tmp_mac = new block[cf->n3];
-                block * tmp_label = new block[cf->n3];
-                bool * tmp_mask_input = new bool[cf->n3];
-                recv_partial_block<SSP>(io, tmp_mac, cf->n3);
-                recv_partial_block<SSP>(io, tmp_label, cf->n3);
-                io.recv_data(tmp_mask_input, cf->n3);
+            std::vector<int> to_alice;
+            for(int i = 0; i < cf->n3; ++i)
+                if(output_party[i] != BOB)
+                    to_alice.push_back(i);
+            if(!to_alice.empty()) {
+                int n = to_alice.size();
+                block * tmp_mac = new block[n];
+                block * tmp_label = new block[n];
+                bool * tmp_mask_input = new bool[n];
+                recv_partial_block<SSP>(io, tmp_mac, n);
+                recv_partial_block<SSP>(io, tmp_label, n);
+                io.recv_data(tmp_mask_input, n);
                 io.flush();
-                for(int i = 0; i < cf->n3; ++i) {
-                    block tmp = tmp_mac[i];
+                for(int k = 0; k < n; ++k) {
+                    int i = to_alice[k];
+                    block tmp = tmp_mac[k];
                     tmp =  tmp & MASK;
 
-                    block ttt = key[cf->num_wire - cf-> n3 + i] ^ fpre->Delta;
+                    block ttt = key[out_start + i] ^ fpre->Delta;
                     ttt =  ttt & MASK;
-                    key[cf->num_wire - cf-> n3 + i] = key[cf->num_wire - cf-> n3 + i] & MASK;
+                    key[out_start + i] = key[out_start + i] & MASK;
 
-                    if(cmpBlock(&tmp, &key[cf->num_wire - cf-> n3 + i], 1))
+                    if(cmpBlock(&tmp, &key[out_start + i], 1))
                         output[i] = false;
                     else if(cmpBlock(&tmp, &ttt, 1))
                         output[i] = true;
                     else throw std::runtime_error("no match output label!");
-                    block mask_label = tmp_label[i];
-                    if(tmp_mask_input[i])
+                    block mask_label = tmp_label[k];
+                    if(tmp_mask_input[k])
                         mask_label = mask_label ^ fpre->Delta;
                     mask_label = mask_label & MASK;
-                    block masked_labels = labels[cf->num_wire - cf-> n3 + i] & MASK;
+                    block masked_labels = labels[out_start + i] & MASK;
                     if(!cmpBlock(&mask_label, &masked_labels, 1))
                         throw std::runtime_error("no match output label2!");
 
-                    output[i] = logic_xor(output[i], tmp_mask_input[i]);
-                    output[i] = logic_xor(output[i], getLSB(mac[cf->num_wire - cf->n3 + i]));
+                    output[i] = logic_xor(output[i], tmp_mask_input[k]);
+                    output[i] = logic_xor(output[i], getLSB(mac[out_start + i]));
                 }
                 delete[] tmp_mac;
                 delete[] tmp_label;
                 delete[] tmp_mask_input;
             }
-
         }
         delete[] mask_input;
+        report_progress("online", cf->num_gate, cf->num_gate);
 
         return output;
     }
@@ -23,6 +23,7 @@ class Feq { public:
         h.digest(dgst);
     }
     bool compare() {
+        TRACE_SCOPE("Feq::compare");
         char AR[Hash::DIGEST_SIZE+16];
         char dgst[Hash::DIGEST_SIZE];
         h.digest(AR);
@@ -15,6 +15,7 @@ class Fpre {
         IOChannel io;
         int batch_size = 0, bucket_size = 0, size = 0;
         int party;
+        int ssp;
         block * keys = nullptr;
         bool * values = nullptr;
         PRG prg;
@@ -28,9 +29,24 @@ class Fpre {
         block * MAC = nullptr, *KEY = nullptr;
         block * MAC_res = nullptr, *KEY_res = nullptr;
         block * pretable = nullptr;
-        Fpre(IOChannel io, int in_party, int bsize = 1000): io(io) {
+        MemTag window_mem{"Fpre::window"};
+        MemTag triples_mem{"Fpre::triples"};
+        // check's and combine's temporaries, reused by every window and
+        // refill until the window buffers are released
+        Arena arena{"Fpre::arena"};
+        // MAC_res/KEY_res hold batch_size checked triples not yet handed out
+        bool ready = false;
+        // Set by C2PC for the length of a refill: the function_independent
+        // total (its AND gates) over which generate, check and combine
+        // report their share. A refill on its own reports nothing.
+        int64_t progress_total = 0;
+        int64_t work_done = 0, work_total = 1;
+        // leaky triples per generate call, so it can report between them
+        const static int GENERATE_CHUNK = 1 << 14;
+        Fpre(IOChannel io, int in_party, int bsize = 1000, int ssp = 40): io(io) {
             prps = new PRP[2];
             this->party = in_party;
+            this->ssp = ssp;
 
             eq[0] = new Feq(io, party);
             eq[1] = new Feq(io, party);
@@ -54,45 +70,64 @@ class Fpre {
             }
             io.flush();
 
-            abit1 = new LeakyDeltaOT(io);
-            abit2 = new LeakyDeltaOT(io);
-            if(party == ALICE) {
-                abit1->setup_send(tmp_s, abit1->k0);
-                abit2->setup_recv(abit2->k0, abit2->k1);
-            } else {
-                abit2->setup_send(tmp_s, abit2->k0);
-                abit1->setup_recv(abit1->k0, abit1->k1);
-            }
-
             if(party == ALICE) Delta = abit1->Delta;
             else Delta = abit2->Delta;
             one = makeBlock(0, 1);
             ZDelta =  Delta  & makeBlock(0xFFFFFFFFFFFFFFFF,0xFFFFFFFFFFFFFFFE);
             set_batch_size(bsize);
         }
+        // Triples are produced in windows, each generated, checked and
+        // bucket-combined on its own, so MAC/KEY only ever hold one window of
+        // leaky triples. A cheat succeeds if it succeeds in any window, so
+        // each window is bucketed for window_ssp = ssp + ceil(log2(num_windows))
+        // bits (see bucketing.h) and the whole batch fails with probability at
+        // most num_windows * 2^-window_ssp <= 2^-ssp. permute_batch_size is
+        // the smallest window that is secure at window_ssp.
         int permute_batch_size;
+        int window_ssp;
+        int num_windows = 1, window_size = 0, window_buffer_size = 0;
         void set_batch_size(int size) {
-            size = std::max(size, 320);
-            batch_size = ((size+1)/2)*2;
-            if(batch_size >= 280*1000) {
-                bucket_size = 3;
-                permute_batch_size = 280000;
-            }
-            else if(batch_size >= 3100) {
-                bucket_size = 4;
-                permute_batch_size = 3100;
+            // more bits per window can change the number of windows, so
+            // repeat until the union bound holds
+            BucketPlan plan;
+            window_ssp = ssp;
+            while(true) {
+                plan = plan_bucketing(size, window_ssp);
+                permute_batch_size = ((plan.min_batch+1)/2)*2;
+                num_windows = std::max(1, plan.batch_size / permute_batch_size);
+                int needed = ssp;
+                while((1LL << (needed - ssp)) < num_windows)
+                    ++needed;
+                if(window_ssp >= needed)
+                    break;
+                window_ssp = needed;
             }
-            else bucket_size = 5;
+            batch_size = plan.batch_size;
+            bucket_size = plan.bucket_size;
+            window_size = ((batch_size / num_windows)/2)*2;
+            int last_window = batch_size - (num_windows-1) * window_size;
 
-            delete[] MAC;
-            delete[] KEY;
+            window_buffer_size = last_window * bucket_size * 3;
+
+            release_window_buffers();
+            delete[] MAC_res;
+            delete[] KEY_res;
 
-            MAC = new block[batch_size * bucket_size * 3];
-            KEY = new block[batch_size * bucket_size * 3];
             MAC_res = new block[batch_size * 3];
             KEY_res = new block[batch_size * 3];
+            triples_mem.set(2 * batch_size * 3 * sizeof(block));
+            ready = false;
 //            cout << size<<"\t"<<batch_size<<"\n";
         }
+        // the leaky triples of one window are only needed during refill
+        void release_window_buffers() {
+            delete[] MAC;
+            delete[] KEY;
+            MAC = nullptr;
+            KEY = nullptr;
+            window_mem.set(0);
+            arena.release();
+        }
         ~Fpre() {
             delete[] MAC;
             delete[] KEY;
@@ -106,78 +141,88 @@ class Fpre {
             delete eq[1];
         }
         void refill() {
-            auto start_time = clock_start();
-
-            int start = 0;
-            int length = batch_size;
-
-            generate(MAC + start * bucket_size*3, KEY + start * bucket_size*3, length * bucket_size);
+            TRACE_SCOPE("Fpre::refill");
+            if(MAC == nullptr) {
+                MAC = new block[window_buffer_size];
+                KEY = new block[window_buffer_size];
+                window_mem.set(2 * window_buffer_size * sizeof(block));
+            }
+            // generate, check and combine each go once over every leaky triple
+            work_done = 0;
+            work_total = 3LL * batch_size * bucket_size;
+            for(int w = 0; w < num_windows; ++w) {
+                int start = w * window_size;
+                int length = (w == num_windows-1) ? batch_size - start : window_size;
+                refill_window(start, length);
+            }
 
-            if(party == ALICE) {
-                // cout <<"ABIT\t"<<time_from(start_time)<<"\n";
-                start_time = clock_start();
+            char dgst[Hash::DIGEST_SIZE];
+            for(int i = 1; i < 2; ++i) {
+                eq[i]->dgst(dgst);
+                eq[0]->add_data(dgst, Hash::DIGEST_SIZE);
             }
+            if(!eq[0]->compare()) {
+                error("FEQ error\n");
+            }
+            ready = true;
+        }
+
+        // fills MAC_res/KEY_res[3*start, 3*(start+length))
+        void refill_window(int start, int length) {
+            generate(MAC, KEY, length * bucket_size);
 
             for(int i = 0; i < 2; ++i) {
-                int start = i*(batch_size/2);
-                int length = batch_size/2;
-                check(MAC + start * bucket_size*3, KEY + start * bucket_size*3, length * bucket_size, i);
-            }
-            if(party == ALICE) {
-                // cout <<"check\t"<<time_from(start_time)<<"\n";
-                start_time = clock_start();
+                int offset = i*(length/2);
+                check(MAC + offset * bucket_size*3, KEY + offset * bucket_size*3, (length/2) * bucket_size, i);
             }
 
 #ifdef __debug
-            check_correctness(MAC, KEY, batch_size);
+            check_correctness(MAC, KEY, length);
 #endif
             block S = coin_tossing(prg, io, party);
-            if(bucket_size > 4) {
-                combine(S, 0, MAC, KEY, batch_size, bucket_size, MAC_res, KEY_res);
-            } else {
-                int width = min((batch_size), permute_batch_size);
-
-                int start = 0;
-                int length = min(width, batch_size);
-                combine(S, 0, MAC+start*bucket_size*3, KEY+start*bucket_size*3, length, bucket_size, MAC_res+start*3, KEY_res+start*3);
-            }
-            if(party == ALICE) {
-                // cout <<"permute\t"<<time_from(start_time)<<"\n";
-                start_time = clock_start();
-            }
+            combine(S, 0, MAC, KEY, length, bucket_size, MAC_res+start*3, KEY_res+start*3);
 
 #ifdef __debug
-            check_correctness(MAC, KEY, batch_size);
+            check_correctness(MAC_res+start*3, KEY_res+start*3, length);
 #endif
-            char dgst[Hash::DIGEST_SIZE];
-            for(int i = 1; i < 2; ++i) {
-                eq[i]->dgst(dgst);
-                eq[0]->add_data(dgst, Hash::DIGEST_SIZE);
-            }
-            if(!eq[0]->compare()) {
-                error("FEQ error\n");
+        }
+
+        // Stays below progress_total: C2PC reports the end of the phase once
+        // its own OTs are done too.
+        void report_work(int64_t work) {
+            work_done += work;
+            if(progress_total > 0) {
+                int64_t done = (int64_t)((double)progress_total * work_done / work_total);
+                Progress::get().update("function_independent", std::min(done, progress_total - 1), progress_total);
             }
         }
 
         void generate(block * MAC, block * KEY, int length) {
-            if (party == ALICE) {
-                abit1->send_dot(KEY, length*3);
-                abit2->recv_dot(MAC, length*3);
-            } else {
-                // TODO: I (Andrew) swapped the two lines below to remove a
-                // deadlock after I removed threading. I suspect that's fine
-                // but I need to check.
-                abit1->recv_dot(MAC, length*3);
-                abit2->send_dot(KEY, length*3);
+            TRACE_SCOPE("Fpre::generate");
+            for(int start = 0; start < length; start += GENERATE_CHUNK) {
+                int n = std::min(GENERATE_CHUNK, length - start);
+                if (party == ALICE) {
+                    abit1->send_dot(KEY + start*3, n*3);
+                    abit2->recv_dot(MAC + start*3, n*3);
+                } else {
+                    // TODO: I (Andrew) swapped the two lines below to remove a
+                    // deadlock after I removed threading. I suspect that's fine
+                    // but I need to check.
+                    abit1->recv_dot(MAC + start*3, n*3);
+                    abit2->send_dot(KEY + start*3, n*3);
+                }
+                report_work(n);
             }
         }
 
         void check(block * MAC, block * KEY, int length, int I) {
-            block * G = new block[length];
-            block * C = new block[length];
-            block * GR = new block[length];
-            bool * d = new bool[length];
-            bool * dR = new bool[length];
+            TRACE_SCOPE("Fpre::check");
+            ArenaScope scope(arena);
+            block * G = arena.alloc<block>(length);
+            block * C = arena.alloc<block>(length);
+            block * GR = arena.alloc<block>(length);
+            bool * d = arena.alloc<bool>(length);
+            bool * dR = arena.alloc<bool>(length);
 
             for (int i = 0; i < length; ++i) {
                 C[i] = KEY[3*i+1] ^ MAC[3*i+1];
@@ -221,11 +266,7 @@ class Fpre {
                 }
                 eq[I]->add_block(G[i]);
             }
-            delete[] G;
-            delete[] GR;
-            delete[] C;
-            delete[] d;
-            delete[] dR;
+            report_work(length);
         }
         block H2D(block a, block b, int I) {
             block d[2];
@@ -252,10 +293,12 @@ class Fpre {
         }
 
         void combine(block S, int I, block * MAC, block * KEY, int length, int bucket_size, block * MAC_res, block * KEY_res) {
-            int *location = new int[length*bucket_size];
+            TRACE_SCOPE("Fpre::combine");
+            ArenaScope scope(arena);
+            int *location = arena.alloc<int>(length*bucket_size);
             for(int i = 0; i < length*bucket_size; ++i) location[i] = i;
             PRG prg(&S, I);
-            int * ind = new int[length*bucket_size];
+            int * ind = arena.alloc<int>(length*bucket_size);
             prg.random_data(ind, length*bucket_size*4);
             for(int i = length*bucket_size-1; i>=0; --i) {
                 int index = ind[i]%(i+1);
@@ -264,10 +307,9 @@ class Fpre {
                 location[i] = location[index];
                 location[index] = tmp;
             }
-            delete[] ind;
 
-            bool *data = new bool[length*bucket_size];
-            bool *data2 = new bool[length*bucket_size];
+            bool *data = arena.alloc<bool>(length*bucket_size);
+            bool *data2 = arena.alloc<bool>(length*bucket_size);
             for(int i = 0; i < length; ++i) {
                 for(int j = 1; j < bucket_size; ++j) {
                     data[i*bucket_size+j] = getLSB(MAC[location[i*bucket_size]*3+1] ^ MAC[location[i*bucket_size+j]*3+1]);
@@ -304,10 +346,7 @@ class Fpre {
                     }
                 }
             }
-
-            delete[] data;
-            delete[] location;
-            delete[] data2;
+            report_work((int64_t)length * bucket_size);
         }
 
 //for debug
@@ -14,6 +14,7 @@ public:
     LeakyDeltaOT(IOChannel io): IKNP(io) {}
 
     void send_dot(block * data, int length) {
+        TRACE_SCOPE("LeakyDeltaOT::send_dot");
         this->send_cot(data, length);
         this->io.flush();
         block one = makeBlock(0xFFFFFFFFFFFFFFFF, 0xFFFFFFFFFFFFFFFE);
@@ -22,6 +23,7 @@ public:
         }
     }
     void recv_dot(block* data, int length) {
+        TRACE_SCOPE("LeakyDeltaOT::recv_dot");
         bool * b = new bool[length];
         this->prg.random_bool(b, length);
         this->recv_cot(data, b, length);
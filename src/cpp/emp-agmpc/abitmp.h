@@ -21,6 +21,8 @@ class ABitMP { public:
     Hash hash;
     int ssp;
     block * pretable;
+    // the checks' temporaries, kept between calls (see Arena)
+    Arena arena{"ABitMP::arena"};
 
     ABitMP(
         std::shared_ptr<IMultiIO>& io,
@@ -74,9 +76,8 @@ class ABitMP { public:
     }
 
     void compute(NVec<block>& MAC, NVec<block>& KEY, bool* data, int length) {
-        for(int i = 1; i <= nP; ++i) for(int j = 1; j<= nP; ++j) if( (i < j) and (i == party or j == party) ) {
-            int party2 = i + j - party;
-
+        TRACE_SCOPE("ABitMP::compute");
+        for_each_peer(nP, party, [&](int party2) {
             if (party < party2) {
                 abit2[party2]->recv_cot(&MAC.at(party2, 0), data, length);
                 io->flush(party2);
@@ -90,7 +91,7 @@ class ABitMP { public:
                 abit2[party2]->recv_cot(&MAC.at(party2, 0), data, length);
                 io->flush(party2);
             }
-        }
+        });
 #ifdef __debug
         check_MAC(nP, *io, MAC, KEY, data, Delta, length, party);
 #endif
@@ -102,16 +103,18 @@ class ABitMP { public:
     }
 
     void check1(const NVec<block>& MAC, const NVec<block>& KEY, bool* data, int length) {
+        TRACE_SCOPE("ABitMP::check1");
+        ArenaScope scope(arena);
         block seed = sampleRandom(nP, *io, &prg, party);
         PRG prg2(&seed);
         uint8_t * tmp;
-        NVec<block> Ms(nP+1, ssp);
-        NVec<bool> bs(nP+1, ssp);
-        NVec<block> Ks(nP+1, ssp);
-        NVec<block> tMs(nP+1, ssp);
-        NVec<bool> tbs(nP+1, ssp);
+        NVec<block> Ms(arena, nP+1, ssp);
+        NVec<bool> bs(arena, nP+1, ssp);
+        NVec<block> Ks(arena, nP+1, ssp);
+        NVec<block> tMs(arena, nP+1, ssp);
+        NVec<bool> tbs(arena, nP+1, ssp);
 
-        tmp = new uint8_t[ssp*length];
+        tmp = arena.alloc<uint8_t>((int64_t)ssp*length);
         prg2.random_data(tmp, ssp*length);
         for(int i = 0; i < ssp*length; ++i)
             tmp[i] = tmp[i] % 4;
@@ -123,9 +126,9 @@ class ABitMP { public:
 
         const int chk = 1;
         const int SIZE = 1024*2;
-        block (* tMAC)[4] = new block[SIZE/chk][4];
-        block (* tKEY)[4] = new block[SIZE/chk][4];
-        bool (* tb)[4] = new bool[length/chk][4];
+        block (* tMAC)[4] = arena.alloc<block[4]>(SIZE/chk);
+        block (* tKEY)[4] = arena.alloc<block[4]>(SIZE/chk);
+        bool (* tb)[4] = arena.alloc<bool[4]>(length/chk);
         memset(tMAC, 0, sizeof(block)*4*SIZE/chk);
         memset(tKEY, 0, sizeof(block)*4*SIZE/chk);
         memset(tb, false, 4*length/chk);
@@ -156,7 +159,6 @@ class ABitMP { public:
                 }
             }
         }
-        delete[] tmp;
         vector<bool> res;
         //TODO: they should not need to send MACs.
         for(int i = 1; i <= nP; ++i) for(int j = 1; j<= nP; ++j) if( (i < j) and (i == party or j == party) ) {
@@ -178,16 +180,18 @@ class ABitMP { public:
         if(checkCheat(res)) error("cheat check1\n");
     }
 
-    void check2(const NVec<block>& MAC, const NVec<block> KEY, bool* data, int length) {
+    void check2(const NVec<block>& MAC, const NVec<block>& KEY, bool* data, int length) {
+        TRACE_SCOPE("ABitMP::check2");
+        ArenaScope scope(arena);
         //last 2*ssp are garbage already.
-        NVec<block> Ks(2, ssp);
-        NVec<block> Ms(nP+1, nP+1, ssp);
-        NVec<block> KK(nP+1, ssp);
-        NVec<bool> bs(nP+1, ssp);
+        NVec<block> Ks(arena, 2, ssp);
+        NVec<block> Ms(arena, nP+1, nP+1, ssp);
+        NVec<block> KK(arena, nP+1, ssp);
+        NVec<bool> bs(arena, nP+1, ssp);
 
-        char (*dgst)[Hash::DIGEST_SIZE] = new char[nP+1][Hash::DIGEST_SIZE];
-        char (*dgst0)[Hash::DIGEST_SIZE] = new char[ssp*(nP+1)][Hash::DIGEST_SIZE];
-        char (*dgst1)[Hash::DIGEST_SIZE] = new char[ssp*(nP+1)][Hash::DIGEST_SIZE];
+        char (*dgst)[Hash::DIGEST_SIZE] = arena.alloc<char[Hash::DIGEST_SIZE]>(nP+1);
+        char (*dgst0)[Hash::DIGEST_SIZE] = arena.alloc<char[Hash::DIGEST_SIZE]>(ssp*(nP+1));
+        char (*dgst1)[Hash::DIGEST_SIZE] = arena.alloc<char[Hash::DIGEST_SIZE]>(ssp*(nP+1));
 
         for(int i = 0; i < ssp; ++i) {
             Ks.at(0, i) = zero_block;
@@ -258,7 +262,7 @@ class ABitMP { public:
             res2.push_back(false);
 
             bool cheat = false;
-            bool *tmp_bool = new bool[ssp];
+            bool *tmp_bool = arena.alloc<bool>(ssp);
             get_recv_channel(*io, party2).recv_data(tmp_bool, ssp);
             get_recv_channel(*io, party2).recv_data(&KK.at(party2, 0), ssp*sizeof(block));
             for(int i = 0; i < ssp; ++i) {
@@ -269,13 +273,12 @@ class ABitMP { public:
                 else
                     cheat = cheat or (strncmp(tmp, dgst0[party2*ssp+i], Hash::DIGEST_SIZE)!=0);
             }
-            delete[] tmp_bool;
             res2.push_back(cheat);
         }
         if(checkCheat(res2)) error("commitments 2\n");
 
         bool cheat = false;
-        block *tmp_block = new block[ssp];
+        block *tmp_block = arena.alloc<block>(ssp);
         for(int i = 1; i <= nP; ++i) if (i != party) {
             memset(tmp_block, 0, sizeof(block)*ssp);
             for(int j = 1; j <= nP; ++j) if(j != i) {
@@ -285,11 +288,6 @@ class ABitMP { public:
             cheat = cheat or !cmpBlock(tmp_block, &KK.at(i, 0), ssp);
         }
         if(cheat) error("cheat aShare\n");
-
-        delete[] dgst;
-        delete[] dgst0;
-        delete[] dgst1;
-        delete[] tmp_block;
     }
 };
 #endif //ABIT_MP_H
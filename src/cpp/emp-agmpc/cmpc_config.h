@@ -1,7 +1,13 @@
 #ifndef CMPC_CONFIG
 #define CMPC_CONFIG
 const static int abit_block_size = 1024;
+// with fpre_threads > 1, per-peer preprocessing (OT extension, leaky ANDs)
+// runs on one thread per peer; the Wasm build has no threads
+#ifdef __EMSCRIPTEN__
 const static int fpre_threads = 1;
+#else
+const static int fpre_threads = 2;
+#endif
 #define LOCALHOST
 
 #ifdef __clang__
@@ -13,6 +19,10 @@ const static char *IPs[] = {""
 ,    "127.0.0.1"
 ,    "127.0.0.1"
 ,    "127.0.0.1"
+,    "127.0.0.1"
+,    "127.0.0.1"
+,    "127.0.0.1"
+,    "127.0.0.1"
 ,    "127.0.0.1"};
 
 #endif // CMPC_CONFIG
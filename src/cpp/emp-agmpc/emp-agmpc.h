@@ -6,6 +6,7 @@
 #include "emp-agmpc/helper.h"
 #include "emp-agmpc/mpc.h"
 #include "emp-agmpc/netmp.h"
+#include "emp-agmpc/preprocess_pool.h"
 #include "emp-agmpc/vec.h"
 #include "emp-agmpc/nvec.h"
 #endif// EMP_AGMPC_H
@@ -100,6 +100,18 @@ public:
         party_assignment[pos] = which_party;
     }
 
+    // Gives group g of consecutive bits (e.g. a Bristol Fashion input group)
+    // to party g+1.
+    void assign_groups(const vector<int>& sizes) {
+        int pos = 0;
+        for(size_t g = 0; g < sizes.size(); ++g)
+            for(int k = 0; k < sizes[g]; ++k) {
+                if(pos >= len) error("input groups are longer than the input");
+                assign_party(pos++, g + 1);
+            }
+        if(pos != len) error("input groups are shorter than the input");
+    }
+
     void assign_plaintext_bit(int pos, bool cur_bit) {
         assert(party_assignment[pos] == party || party_assignment[pos] == -2  || party_assignment[pos] == 0);
         plaintext_assignment[pos] = cur_bit;
@@ -540,6 +552,7 @@ public:
     IMultiIO* io;
     block Delta;
     block *labels;
+    int evaluator = 1;
 
     vector<int> party_assignment;
     // -1 represents an authenticated share,
@@ -571,16 +584,18 @@ public:
         NVec<block>& associated_mac,
         NVec<block>& associated_key,
         NVec<block>& associated_eval_labels,
-        Vec<block>& associated_labels,
+        AlignedBuffer<block>& associated_labels,
         std::shared_ptr<IMultiIO>& associated_io,
-        block associated_Delta
+        block associated_Delta,
+        int associated_evaluator = 1
     ) {
         this->cmpc_associated = true;
+        this->evaluator = associated_evaluator;
         this->value = associated_value;
-        this->labels = &associated_labels.at(0);
+        this->labels = associated_labels.data();
         this->mac = &associated_mac;
         this->key = &associated_key;
-        if (party == ALICE){
+        if (party == evaluator){
             this->eval_labels = &associated_eval_labels;
         }
         this->io = &*associated_io;
@@ -591,6 +606,18 @@ public:
         party_assignment[pos] = which_party;
     }
 
+    // Gives group g of consecutive bits (e.g. a Bristol Fashion output group)
+    // to party g+1.
+    void assign_groups(const vector<int>& sizes) {
+        int pos = 0;
+        for(size_t g = 0; g < sizes.size(); ++g)
+            for(int k = 0; k < sizes[g]; ++k) {
+                if(pos >= len) error("output groups are longer than the output");
+                assign_party(pos++, g + 1);
+            }
+        if(pos != len) error("output groups are shorter than the output");
+    }
+
     bool get_plaintext_bit(int pos) {
         assert(party_assignment[pos] == party || party_assignment[pos] == 0);
         return plaintext_results[pos];
@@ -600,33 +627,50 @@ public:
         return len;
     }
 
+    // whether party p learns output bit i in plaintext
+    bool opened_to(int i, int p) const {
+        return party_assignment[i] == 0 || party_assignment[i] == p;
+    }
+
+    // whether party p needs the evaluator's label for output bit i
+    bool label_needed_by(int i, int p) const {
+        return opened_to(i, p) || party_assignment[i] == -1;
+    }
+
     void output(bool *masked_input_ret, int output_shift) {
         assert(cmpc_associated);
 
         /*
-         * Party 1 sends the labels of all the output wires out.
+         * The evaluator sends each party the labels of the output wires it
+         * needs; bits that go to other parties are not sent.
          */
         vector<block> output_wire_label_recv;
         output_wire_label_recv.resize(len);
 
-        if(party == ALICE) {
-            vector<vector<block>> output_wire_label_send;
-            output_wire_label_send.resize(nP + 1);
-
-            for (int j = 2; j <= nP; j++) {
-                output_wire_label_send[j].resize(len);
-                for(int i = 0; i < len; i++) {
-                    output_wire_label_send[j][i] = eval_labels->at(j, output_shift + i);
+        if(party == evaluator) {
+            for(int j = 1; j <= nP; j++) if(j != evaluator) {
+                vector<block> output_wire_label_send;
+                for(int i = 0; i < len; i++) if(label_needed_by(i, j)) {
+                    output_wire_label_send.push_back(eval_labels->at(j, output_shift + i));
+                }
+                if(!output_wire_label_send.empty()) {
+                    get_send_channel(*io, j).send_data(output_wire_label_send.data(), sizeof(block) * output_wire_label_send.size());
+                    io->flush(j);
                 }
-            }
-
-            for(int j = 2; j <= nP; j++) {
-                get_send_channel(*io, j).send_data(output_wire_label_send[j].data(), sizeof(block) * len);
-                io->flush(j);
             }
         }else {
-            get_recv_channel(*io, ALICE).recv_data(output_wire_label_recv.data(), sizeof(block) * len);
-            io->flush(ALICE);
+            vector<block> labels_recv;
+            for(int i = 0; i < len; i++) if(label_needed_by(i, party)) {
+                labels_recv.push_back(zero_block);
+            }
+            if(!labels_recv.empty()) {
+                get_recv_channel(*io, evaluator).recv_data(labels_recv.data(), sizeof(block) * labels_recv.size());
+                io->flush(evaluator);
+            }
+            int k = 0;
+            for(int i = 0; i < len; i++) if(label_needed_by(i, party)) {
+                output_wire_label_recv[i] = labels_recv[k++];
+            }
         }
 
         /*
@@ -635,12 +679,12 @@ public:
         vector<bool> masked_output;
         masked_output.resize(len);
 
-        if(party == ALICE) {
+        if(party == evaluator) {
             for(int i = 0; i < len; i++) {
                 masked_output[i] = masked_input_ret[output_shift + i];
             }
         } else {
-            for(int i = 0; i < len; i++) {
+            for(int i = 0; i < len; i++) if(label_needed_by(i, party)) {
                 block cur_label = output_wire_label_recv[i];
                 block zero_label = labels[i + output_shift];
                 block one_label = zero_label ^ Delta;
@@ -667,7 +711,7 @@ public:
 
         for(int i = 0; i < len; i++) {
             if(party_assignment[i] == -1) {
-                // do nothing, just update the share (for the first party) later
+                // do nothing, just update the share (for the evaluator) later
             } else if(party_assignment[i] == 0) {
                 // public output, all parties receive the mbit
                 for(int j = 1; j <= nP; j++){
@@ -683,7 +727,7 @@ public:
         }
 
         /*
-         * Exchange the output mask
+         * Exchange the output mask, only for the bits the receiver learns
          */
         vector<vector<BitWithMac>> output_mask_recv;
         output_mask_recv.resize(nP + 1);
@@ -696,10 +740,25 @@ public:
                 if ((i < j) and (i == party or j == party)) {
                     int party2 = i + j - party;
 
-                    get_send_channel(*io, party2).send_data(output_mask_send[party2].data(), sizeof(BitWithMac) * len);
-                    io->flush(party2);
-                    get_recv_channel(*io, party2).recv_data(output_mask_recv[party2].data(), sizeof(BitWithMac) * len);
-                    io->flush(party2);
+                    vector<BitWithMac> send_packed, recv_packed;
+                    for(int k = 0; k < len; k++) {
+                        if(opened_to(k, party2)) send_packed.push_back(output_mask_send[party2][k]);
+                        if(opened_to(k, party)) recv_packed.push_back(BitWithMac{});
+                    }
+
+                    if(!send_packed.empty()) {
+                        get_send_channel(*io, party2).send_data(send_packed.data(), sizeof(BitWithMac) * send_packed.size());
+                        io->flush(party2);
+                    }
+                    if(!recv_packed.empty()) {
+                        get_recv_channel(*io, party2).recv_data(recv_packed.data(), sizeof(BitWithMac) * recv_packed.size());
+                        io->flush(party2);
+                    }
+
+                    int n = 0;
+                    for(int k = 0; k < len; k++) if(opened_to(k, party)) {
+                        output_mask_recv[party2][k] = recv_packed[n++];
+                    }
                 }
             }
         }
@@ -712,7 +771,7 @@ public:
             if(j != party) {
                 bool check = false;
                 for (int i = 0; i < len; i++) {
-                    if (party_assignment[i] == party || party_assignment[i] == 0) {
+                    if (opened_to(i, party)) {
                         block supposed_mac = Delta & select_mask[output_mask_recv[j][i].bit_share? 1 : 0];
                         supposed_mac ^= key->at(j, output_shift + i);
 
@@ -732,7 +791,7 @@ public:
         /*
          * Handle the case party_assignment[] = -1
          */
-        if(party == ALICE) {
+        if(party == evaluator) {
             for(int i = 0; i < len; i++) {
                 if(party_assignment[i] == -1) {
                     authenticated_share_results[i].bit_share = value[output_shift + i] ^ masked_output[i];
@@ -751,10 +810,10 @@ public:
                     for(int j = 1; j <= nP; j++) {
                         if(j != party) {
                             authenticated_share_results[i].mac[j] = mac->at(j, output_shift + i);
-                            if(j == ALICE) {
+                            if(j == evaluator) {
                                 authenticated_share_results[i].key[j] =
                                         key->at(j, output_shift + i) ^ (Delta & select_mask[masked_output[i] ? 1 : 0]);
-                                // change the MAC key for the first party
+                                // change the MAC key for the evaluator
                             } else {
                                 authenticated_share_results[i].key[j] = key->at(j, output_shift + i);
                             }
@@ -795,7 +854,7 @@ public:
          * Handle the case party_assignment[] = 0 or == party
          */
         for(int i = 0; i < len; i++) {
-            if(party_assignment[i] == 0 || party_assignment[i] == party) {
+            if(opened_to(i, party)) {
                 plaintext_results[i] = value[output_shift + i] ^ masked_output[i];
                 for(int j = 1; j <= nP; j++) {
                     if(j != party) {
@@ -21,6 +21,9 @@ class FpreMP { public:
     PRG * prgs;
     PRG prg;
     int ssp;
+    // compute's temporaries, kept between calls (see Arena); not for the
+    // per-peer lambdas, which may run on threads
+    Arena arena{"FpreMP::arena"};
 
     FpreMP(
         std::shared_ptr<IMultiIO>& io,
@@ -44,50 +47,45 @@ class FpreMP { public:
         delete[] prgs;
         delete abit;
     }
-    int get_bucket_size(int size) {
-        size = max(size, 320);
-        int batch_size = ((size+2-1)/2)*2;
-        if(batch_size >= 280*1000)
-            return 3;
-        else if(batch_size >= 3100)
-            return 4;
-        else return 5;
-    }
     void compute(NVec<block>& MAC, NVec<block>& KEY, bool* r, int length) {
-        int64_t bucket_size = get_bucket_size(length);
-        NVec<block> tMAC(nP+1, length*bucket_size*3+3*ssp);
-        NVec<block> tKEY(nP+1, length*bucket_size*3+3*ssp);
-        NVec<block> tKEYphi(nP+1, length*bucket_size*3+3*ssp);
-        NVec<block> tMACphi(nP+1, length*bucket_size*3+3*ssp);
-        Vec<block> phi(length*bucket_size);
-        NVec<block> X(nP+1, ssp);
-        Vec<bool> tr(length*bucket_size*3+3*ssp);
-        NVec<bool> s(nP+1, length*bucket_size);
-        Vec<bool> e(length*bucket_size);
-
-        prg.random_bool(&tr[0], length*bucket_size*3+3*ssp);
-        // memset(tr, false, length*bucket_size*3+3*ssp);
-        abit->compute(tMAC, tKEY, &tr[0], length*bucket_size*3 + 3*ssp);
-
-        for(int i = 1; i <= nP; ++i) for(int j = 1; j <= nP; ++j) if (i < j ) {
-            if(i == party) {
-                prgs[j].random_bool(&s.at(j, 0), length*bucket_size);
-                for(int k = 0; k < length*bucket_size; ++k) {
-                    uint8_t data = garble(&tKEY.at(j, 0), &tr[0], &s.at(j, 0), k, j);
-                    get_send_channel(*io, j).send_data(&data, 1);
-                    s.at(j, k) = (s.at(j, k) != (tr[3*k] and tr[3*k+1]));
-                }
-                io->flush(j);
-            } else if (j == party) {
-                for(int k = 0; k < length*bucket_size; ++k) {
-                    uint8_t data = 0;
-                    get_recv_channel(*io, i).recv_data(&data, 1);
-                    bool tmp = evaluate(data, &tMAC.at(i, 0), &tr[0], k, i);
-                    s.at(i, k) = (tmp != (tr[3*k] and tr[3*k+1]));
-                }
+        TRACE_SCOPE("FpreMP::compute");
+        // the plan may pad the batch when that allows a smaller bucket;
+        // only the first `length` buckets are combined
+        BucketPlan plan = plan_bucketing(length, ssp);
+        int64_t bucket_size = plan.bucket_size;
+        int64_t leaky = (int64_t)plan.batch_size * bucket_size;
+        ArenaScope scope(arena);
+        NVec<block> tMAC(arena, nP+1, leaky*3+3*ssp);
+        NVec<block> tKEY(arena, nP+1, leaky*3+3*ssp);
+        NVec<block> tKEYphi(arena, nP+1, leaky*3+3*ssp);
+        NVec<block> tMACphi(arena, nP+1, leaky*3+3*ssp);
+        Vec<block> phi(arena.alloc<block>(leaky), leaky);
+        NVec<block> X(arena, nP+1, ssp);
+        Vec<bool> tr(arena.alloc<bool>(leaky*3+3*ssp), leaky*3+3*ssp);
+        NVec<bool> s(arena, nP+1, leaky);
+        Vec<bool> e(arena.alloc<bool>(leaky), leaky);
+
+        prg.random_bool(&tr[0], leaky*3+3*ssp);
+        // memset(tr, false, leaky*3+3*ssp);
+        abit->compute(tMAC, tKEY, &tr[0], leaky*3 + 3*ssp);
+        // milestones, in quarters of the batch
+        Progress::get().update("function_independent", length/4, length);
+
+        for_each_peer(nP, party, [&](int party2) {
+            Vec<uint8_t> tables((leaky+1)/2);
+            if(party < party2) {
+                prgs[party2].random_bool(&s.at(party2, 0), leaky);
+                garble(&tables[0], &tKEY.at(party2, 0), &tr[0], &s.at(party2, 0), leaky, party2);
+                get_send_channel(*io, party2).send_data(&tables[0], (leaky+1)/2);
+                io->flush(party2);
+            } else {
+                get_recv_channel(*io, party2).recv_data(&tables[0], (leaky+1)/2);
+                evaluate(&s.at(party2, 0), &tables[0], &tMAC.at(party2, 0), &tr[0], leaky, party2);
             }
-        }
-        for(int k = 0; k < length*bucket_size; ++k) {
+            for(int k = 0; k < leaky; ++k)
+                s.at(party2, k) = (s.at(party2, k) != (tr[3*k] and tr[3*k+1]));
+        });
+        for(int k = 0; k < leaky; ++k) {
             s.at(0, k) = (tr[3*k] and tr[3*k+1]);
             for(int i = 1; i <= nP; ++i)
                 if (i != party) {
@@ -98,28 +96,31 @@ class FpreMP { public:
         }
 
 #ifdef __debug
-        check_correctness(nP, *io, &tr[0], length*bucket_size, party);
+        check_correctness(nP, *io, &tr[0], leaky, party);
 #endif
         for(int i = 1; i <= nP; ++i) for(int j = 1; j<= nP; ++j) if( (i < j) and (i == party or j == party) ) {
             int party2 = i + j - party;
 
-            get_send_channel(*io, party2).send_data(&e[0], length*bucket_size);
+            get_send_channel(*io, party2).send_data(&e[0], leaky);
             io->flush(party2);
 
-            bool * tmp = new bool[length*bucket_size];
-            get_recv_channel(*io, party2).recv_data(tmp, length*bucket_size);
-            for(int k = 0; k < length*bucket_size; ++k) {
+            ArenaScope scope(arena);
+            bool * tmp = arena.alloc<bool>(leaky);
+            get_recv_channel(*io, party2).recv_data(tmp, leaky);
+            for(int k = 0; k < leaky; ++k) {
                 if(tmp[k])
                     tKEY.at(party2, 3*k+2) = tKEY.at(party2, 3*k+2) ^ Delta;
             }
-            delete[] tmp;
         }
 #ifdef __debug
-        check_MAC(nP, *io, tMAC, tKEY, &tr[0], Delta, length*bucket_size*3, party);
+        check_MAC(nP, *io, tMAC, tKEY, &tr[0], Delta, leaky*3, party);
 #endif
-        abit->check(tMAC, tKEY, &tr[0], length*bucket_size*3 + 3*ssp);
+        Progress::get().update("function_independent", length/2, length);
+        abit->check(tMAC, tKEY, &tr[0], leaky*3 + 3*ssp);
+        Progress::get().update("function_independent", 3*(length/4), length);
+        TraceSpan check_span("FpreMP::check_and");
         //check compute phi
-        for(int k = 0; k < length*bucket_size; ++k) {
+        for(int k = 0; k < leaky; ++k) {
             phi[k] = zero_block;
             for(int i = 1; i <= nP; ++i) if (i != party) {
                 phi[k] = phi[k] ^ tKEY.at(i, 3*k+1);
@@ -128,13 +129,11 @@ class FpreMP { public:
             if(tr[3*k+1])phi[k] = phi[k] ^ Delta;
         }
 
-        for(int i = 1; i <= nP; ++i) for(int j = 1; j<= nP; ++j) if( (i < j) and (i == party or j == party) ) {
-            int party2 = i + j - party;
-
+        for_each_peer(nP, party, [&](int party2) {
             if (party < party2) {
                 {
                     block bH[2], tmpH[2];
-                    for(int k = 0; k < length*bucket_size; ++k) {
+                    for(int k = 0; k < leaky; ++k) {
                         bH[0] = tKEY.at(party2, 3*k);
                         bH[1] = bH[0] ^ Delta;
                         HnID(prps+party2, bH, bH, 2*k, 2, tmpH);
@@ -148,7 +147,7 @@ class FpreMP { public:
 
                 {
                     block bH;
-                    for(int k = 0; k < length*bucket_size; ++k) {
+                    for(int k = 0; k < leaky; ++k) {
                         get_recv_channel(*io, party2).recv_data(&bH, sizeof(block));
                         block hin = sigma(tMAC.at(party2, 3*k)) ^ makeBlock(0, 2*k+tr[3*k]);
                         tMACphi.at(party2, k) = prps2[party2].H(hin);
@@ -158,7 +157,7 @@ class FpreMP { public:
             } else {
                 {
                     block bH;
-                    for(int k = 0; k < length*bucket_size; ++k) {
+                    for(int k = 0; k < leaky; ++k) {
                         get_recv_channel(*io, party2).recv_data(&bH, sizeof(block));
                         block hin = sigma(tMAC.at(party2, 3*k)) ^ makeBlock(0, 2*k+tr[3*k]);
                         tMACphi.at(party2, k) = prps2[party2].H(hin);
@@ -168,7 +167,7 @@ class FpreMP { public:
 
                 {
                     block bH[2], tmpH[2];
-                    for(int k = 0; k < length*bucket_size; ++k) {
+                    for(int k = 0; k < leaky; ++k) {
                         bH[0] = tKEY.at(party2, 3*k);
                         bH[1] = bH[0] ^ Delta;
                         HnID(prps+party2, bH, bH, 2*k, 2, tmpH);
@@ -180,16 +179,16 @@ class FpreMP { public:
                     io->flush(party2);
                 }
             }
-        }
+        });
 
-        bool * xs = new bool[length*bucket_size];
-        for(int i = 0; i < length*bucket_size; ++i) xs[i] = tr[3*i];
+        bool * xs = arena.alloc<bool>(leaky);
+        for(int i = 0; i < leaky; ++i) xs[i] = tr[3*i];
 
 #ifdef __debug
-        check_MAC_phi(tMACphi, tKEYphi, &phi[0], xs, length*bucket_size);
+        check_MAC_phi(tMACphi, tKEYphi, &phi[0], xs, leaky);
 #endif
         //tKEYphti use as H
-        for(int k = 0; k < length*bucket_size; ++k) {
+        for(int k = 0; k < leaky; ++k) {
             tKEYphi.at(party, k) = zero_block;
             for(int i = 1; i <= nP; ++i) if (i != party) {
                 tKEYphi.at(party, k) = tKEYphi.at(party, k) ^ tKEYphi.at(i, k);
@@ -202,16 +201,16 @@ class FpreMP { public:
         }
 
 #ifdef __debug
-        check_zero(&tKEYphi.at(party, 0), length*bucket_size);
+        check_zero(&tKEYphi.at(party, 0), leaky);
 #endif
 
         block prg_key = sampleRandom(nP, *io, &prg, party);
         PRG prgf(&prg_key);
-        char (*dgst)[Hash::DIGEST_SIZE] = new char[nP+1][Hash::DIGEST_SIZE];
-        bool * tmp = new bool[length*bucket_size];
+        char (*dgst)[Hash::DIGEST_SIZE] = arena.alloc<char[Hash::DIGEST_SIZE]>(nP+1);
+        bool * tmp = arena.alloc<bool>(leaky);
         for(int i = 0; i < ssp; ++i) {
-            prgf.random_bool(tmp, length*bucket_size);
-            X.at(party, i) = inProd(tmp, &tKEYphi.at(party, 0), length*bucket_size);
+            prgf.random_bool(tmp, leaky);
+            X.at(party, i) = inProd(tmp, &tKEYphi.at(party, 0), leaky);
         }
         Hash::hash_once(dgst[party], &X.at(party, 0), sizeof(block)*ssp);
 
@@ -237,25 +236,26 @@ class FpreMP { public:
             xorBlocks_arr(&X.at(1, 0), &X.at(1, 0), &X.at(i, 0), ssp);
         for(int i = 0; i < ssp; ++i)X.at(2, i) = zero_block;
         if(!cmpBlock(&X.at(1, 0), &X.at(2, 0), ssp)) error("AND check");
+        check_span.end();
 
         //land -> and
+        TRACE_SCOPE("FpreMP::combine");
         block S = sampleRandom(nP, *io, &prg, party);
 
-        int * ind = new int[length*bucket_size];
-        int *location = new int[length*bucket_size];
-        NVec<bool> d(nP+1, length*(bucket_size-1));
-        for(int i = 0; i < length*bucket_size; ++i)
+        int * ind = arena.alloc<int>(leaky);
+        int *location = arena.alloc<int>(leaky);
+        NVec<bool> d(arena, nP+1, length*(bucket_size-1));
+        for(int i = 0; i < leaky; ++i)
             location[i] = i;
         PRG prg2(&S);
-        prg2.random_data(ind, length*bucket_size*4);
-        for(int i = length*bucket_size-1; i>=0; --i) {
+        prg2.random_data(ind, leaky*4);
+        for(int i = leaky-1; i>=0; --i) {
             int index = ind[i]%(i+1);
             index = index>0? index:(-1*index);
             int tmp = location[i];
             location[i] = location[index];
             location[index] = tmp;
         }
-        delete[] ind;
 
         for(int i = 0; i < length; ++i) {
             for(int j = 0; j < bucket_size-1; ++j)
@@ -310,42 +310,68 @@ class FpreMP { public:
 //        ret.get();
     }
 
-    //TODO: change to justGarble
-    uint8_t garble(block * KEY, bool * r, bool * r2, int i, int I) {
-        uint8_t data = 0;
-        block tmp[4], tmp2[4], tmpH[4];
-        tmp[0] = KEY[3*i];
-        tmp[1] = tmp[0] ^ Delta;
-        tmp[2] = KEY[3*i+1];
-        tmp[3] = tmp[2] ^ Delta;
-        HnID(prps+I, tmp, tmp, 4*i, 4, tmpH);
-
-        tmp2[0] = tmp[0] ^ tmp[2];
-        tmp2[1] = tmp[1] ^ tmp[2];
-        tmp2[2] = tmp[0] ^ tmp[3];
-        tmp2[3] = tmp[1] ^ tmp[3];
-
-        data = getLSB(tmp2[0]);
-        data |= (getLSB(tmp2[1])<<1);
-        data |= (getLSB(tmp2[2])<<2);
-        data |= (getLSB(tmp2[3])<<3);
-        if ( ((false != r[3*i] ) && (false != r[3*i+1])) != r2[i] )
-            data= data ^ 0x1;
-        if ( ((true != r[3*i] ) && (false != r[3*i+1])) != r2[i] )
-            data = data ^ 0x2;
-        if ( ((false != r[3*i] ) && (true != r[3*i+1])) != r2[i] )
-            data = data ^ 0x4;
-        if ( ((true != r[3*i] ) && (true != r[3*i+1])) != r2[i] )
-            data = data ^ 0x8;
-        return data;
+    // Leaky-AND tables for `length` ANDs, one 4-bit table per AND and two per
+    // byte. Hashing is done a chunk of ANDs at a time.
+    void garble(uint8_t * tables, block * KEY, bool * r, bool * r2, int64_t length, int I) {
+        TRACE_SCOPE("FpreMP::garble");
+        const int64_t chunk = abit_block_size;
+        block * tmp = new block[4*chunk];
+        block * scratch = new block[4*chunk];
+        memset(tables, 0, (length+1)/2);
+        for(int64_t start = 0; start < length; start += chunk) {
+            int64_t n = min(chunk, length - start);
+            for(int64_t k = 0; k < n; ++k) {
+                tmp[4*k] = KEY[3*(start+k)];
+                tmp[4*k+1] = tmp[4*k] ^ Delta;
+                tmp[4*k+2] = KEY[3*(start+k)+1];
+                tmp[4*k+3] = tmp[4*k+2] ^ Delta;
+            }
+            HnID(prps+I, tmp, tmp, 4*start, 4*n, scratch);
+
+            for(int64_t k = 0; k < n; ++k) {
+                int64_t i = start + k;
+                block * h = tmp + 4*k;
+                uint8_t data = getLSB(h[0] ^ h[2]);
+                data |= (getLSB(h[1] ^ h[2])<<1);
+                data |= (getLSB(h[0] ^ h[3])<<2);
+                data |= (getLSB(h[1] ^ h[3])<<3);
+                if ( ((false != r[3*i] ) && (false != r[3*i+1])) != r2[i] )
+                    data= data ^ 0x1;
+                if ( ((true != r[3*i] ) && (false != r[3*i+1])) != r2[i] )
+                    data = data ^ 0x2;
+                if ( ((false != r[3*i] ) && (true != r[3*i+1])) != r2[i] )
+                    data = data ^ 0x4;
+                if ( ((true != r[3*i] ) && (true != r[3*i+1])) != r2[i] )
+                    data = data ^ 0x8;
+                tables[i/2] |= data << (4*(i%2));
+            }
+        }
+        delete[] tmp;
+        delete[] scratch;
     }
-    bool evaluate(uint8_t tmp, block * MAC, bool * r, int i, int I) {
-        block hin = sigma(MAC[3*i]) ^ makeBlock(0, 4*i + r[3*i]);
-        block hin2 = sigma(MAC[3*i+1]) ^ makeBlock(0, 4*i + 2 + r[3*i+1]);
-        block bH = prps[I].H(hin) ^ prps[I].H(hin2);
-        uint8_t res = getLSB(bH);
-        tmp >>= (r[3*i+1]*2+r[3*i]);
-        return (tmp&0x1) != (res&0x1);
+    void evaluate(bool * res, const uint8_t * tables, block * MAC, bool * r, int64_t length, int I) {
+        TRACE_SCOPE("FpreMP::evaluate");
+        const int64_t chunk = abit_block_size;
+        block * hin = new block[2*chunk];
+        block * scratch = new block[2*chunk];
+        for(int64_t start = 0; start < length; start += chunk) {
+            int64_t n = min(chunk, length - start);
+            for(int64_t k = 0; k < n; ++k) {
+                int64_t i = start + k;
+                hin[2*k] = sigma(MAC[3*i]) ^ makeBlock(0, 4*i + r[3*i]);
+                hin[2*k+1] = sigma(MAC[3*i+1]) ^ makeBlock(0, 4*i + 2 + r[3*i+1]);
+            }
+            prps[I].Hn(hin, hin, 2*n, scratch);
+
+            for(int64_t k = 0; k < n; ++k) {
+                int64_t i = start + k;
+                uint8_t tmp = tables[i/2] >> (4*(i%2));
+                tmp >>= (r[3*i+1]*2+r[3*i]);
+                res[i] = (tmp&0x1) != getLSB(hin[2*k] ^ hin[2*k+1]);
+            }
+        }
+        delete[] hin;
+        delete[] scratch;
     }
 
     void check_MAC_phi(const NVec<block>& MAC, const NVec<block>& KEY, block * phi, bool * r, int length) {
@@ -62,6 +62,22 @@ void joinNclean(vector<future<T>>& res) {
     res.clear();
 }
 
+// Calls f(party2) for every other party, in the same pair order on all
+// parties. Each peer has its own channels, so with fpre_threads > 1 every
+// peer gets its own thread; all of them are joined before returning.
+template<typename F>
+void for_each_peer(int nP, int party, F f) {
+    vector<future<void>> res;
+    for(int i = 1; i <= nP; ++i) for(int j = 1; j<= nP; ++j) if( (i < j) and (i == party or j == party) ) {
+        int party2 = i + j - party;
+        if(fpre_threads > 1)
+            res.push_back(std::async(std::launch::async, f, party2));
+        else
+            f(party2);
+    }
+    joinNclean(res);
+}
+
 bool checkCheat(vector<bool>& res) {
     bool cheat = false;
     for(auto v: res) cheat = cheat or v;
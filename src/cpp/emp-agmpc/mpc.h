@@ -6,13 +6,15 @@
 #include "vec.h"
 #include "nvec.h"
 #include "flexible_input_output.h"
+#include "preprocess_pool.h"
 #include <emp-tool/emp-tool.h>
 using namespace emp;
 
 class CMPC { public:
     const static int SSP = 5;//5*8 in fact...
-    const block MASK = makeBlock(0x0ULL, 0xFFFFFULL);
+    const block MASK = makeBlock(0x0ULL, 0xFFFFFFFFFFULL); // low SSP bytes
     FpreMP* fpre = nullptr;
+    PreprocessPool* pool = nullptr;
 
     NVec<block> mac; // dim: parties, wires
     NVec<block> key; // dim: parties, wires
@@ -30,51 +32,88 @@ class CMPC { public:
     NVec<block> ANDS_key; // dim: parties, num_ands*3
     Vec<bool> ANDS_value; // dim: num_ands*3
 
-    Vec<block> labels; // dim: wires
+    AlignedBuffer<block> labels; // dim: wires
     BristolFormat * cf;
     std::shared_ptr<IMultiIO> io;
     int nP;
     int num_ands = 0, num_in;
     int party, total_pre, ssp;
+    // the party that receives the garbled tables and evaluates; party 1
+    // always holds the public constant bit, whoever evaluates
+    int evaluator;
     block Delta;
 
-    NVec<block> GTM; // dim: num_ands, 4, parties
-    NVec<block> GTK; // dim: num_ands, 4, parties
-    NVec<bool> GTv; // dim: num_ands, 4
-    NVec<block> GT; // dim: num_ands, parties, 4, parties
+    // The evaluator's tables, kept until online, as one record per AND gate
+    // and row (see gate_row). If they are larger than spill_threshold bytes
+    // they are spilled to a temporary file (native only); -1 keeps them in
+    // memory.
+    int64_t spill_threshold = -1;
+    SpillBuffer<block> GT{"CMPC::GT"}; // dim: num_ands, 4, row_blocks
+    size_t row_blocks = 0;
     NVec<block> eval_labels; // dim: parties, wires
     PRP prp;
 
+    // the vectors above, in MemAccount
+    MemTag wires_mem{"CMPC::wires"};
+    MemTag preprocess_mem{"CMPC::preprocess"};
+    MemTag sigma_mem{"CMPC::sigma"};
+    MemTag ands_mem{"CMPC::ANDS"};
+
     CMPC(
         std::shared_ptr<IMultiIO>& io,
         BristolFormat * cf,
         bool * _delta = nullptr,
-        int ssp = 40
+        int ssp = 40,
+        int evaluator = 1
     ):
         io(io),
         nP(io->size()),
-        party(io->party())
+        party(io->party()),
+        evaluator(evaluator)
     {
         this->cf = cf;
         this->ssp = ssp;
+        fpre = new FpreMP(io, _delta, ssp);
+        Delta = fpre->Delta;
+        init();
+    }
 
+    // Runs with triples and abits taken from a pool generated earlier by the
+    // same parties, so no preprocessing (or base OT) happens here.
+    CMPC(
+        std::shared_ptr<IMultiIO>& io,
+        BristolFormat * cf,
+        PreprocessPool * pool,
+        int evaluator = 1
+    ):
+        pool(pool),
+        io(io),
+        nP(io->size()),
+        party(io->party()),
+        evaluator(evaluator)
+    {
+        if(pool->nP != nP or pool->party != party)
+            error("preprocess pool belongs to a different party setup");
+        this->cf = cf;
+        this->ssp = pool->ssp;
+        Delta = pool->Delta;
+        init();
+    }
+    ~CMPC() {
+        delete fpre;
+    }
+
+    void init() {
+        if(evaluator < 1 or evaluator > nP)
+            error("evaluator must be one of the parties");
         for(int i = 0; i < cf->num_gate; ++i) {
             if (cf->gates[4*i+3] == AND_GATE)
                 ++num_ands;
         }
         num_in = cf->n1+cf->n2;
         total_pre = num_in + num_ands + 3*ssp;
-        fpre = new FpreMP(io, _delta, ssp);
-        Delta = fpre->Delta;
-
-        if(party == 1) {
-            GTM.resize(num_ands, 4, nP+1);
-            GTK.resize(num_ands, 4, nP+1);
-            GTv.resize(num_ands, 4);
-            GT.resize(num_ands, nP+1, 4, nP+1);
-        }
 
-        labels.resize(cf->num_wire);
+        labels = AlignedBuffer<block>(cf->num_wire);
         key.resize(nP+1, cf->num_wire);
         mac.resize(nP+1, cf->num_wire);
         ANDS_key.resize(nP+1, num_ands*3);
@@ -89,21 +128,34 @@ class CMPC { public:
         ANDS_value.resize(num_ands*3);
         preprocess_value.resize(total_pre);
         sigma_value.resize(num_ands);
-    }
-    ~CMPC() {
-        delete fpre;
+
+        wires_mem.set((3 * (nP+1) + 1) * cf->num_wire * sizeof(block) + cf->num_wire);
+        preprocess_mem.set(2 * (nP+1) * total_pre * sizeof(block) + total_pre);
+        sigma_mem.set(2 * (nP+1) * num_ands * sizeof(block) + num_ands);
+        ands_mem.set(2 * (nP+1) * num_ands * 3 * sizeof(block) + num_ands * 3);
     }
     PRG prg;
 
     void function_independent() {
-        if(party != 1)
+        TRACE_SCOPE("CMPC::function_independent");
+        report_progress("function_independent", 0, num_ands);
+        if(party != evaluator)
             prg.random_block(&labels[0], cf->num_wire);
 
-        fpre->compute(ANDS_mac, ANDS_key, &ANDS_value[0], num_ands);
-
-        prg.random_bool(&preprocess_value[0], total_pre);
-        fpre->abit->compute(preprocess_mac, preprocess_key, &preprocess_value[0], total_pre);
-        fpre->abit->check(preprocess_mac, preprocess_key, &preprocess_value[0], total_pre);
+        if(pool != nullptr) {
+            pool->sync(*io);
+            pool->take_ands(ANDS_mac, ANDS_key, &ANDS_value[0], num_ands);
+            pool->take_abits(preprocess_mac, preprocess_key, &preprocess_value[0], num_in + num_ands);
+        } else {
+            fpre->compute(ANDS_mac, ANDS_key, &ANDS_value[0], num_ands);
+
+            prg.random_bool(&preprocess_value[0], total_pre);
+            fpre->abit->compute(preprocess_mac, preprocess_key, &preprocess_value[0], total_pre);
+            fpre->abit->check(preprocess_mac, preprocess_key, &preprocess_value[0], total_pre);
+            // preprocessing is over, so are its temporaries
+            fpre->arena.release();
+            fpre->abit->arena.release();
+        }
 
         for(int i = 1; i <= nP; ++i) {
             memcpy(&key.at(i, 0), &preprocess_key.at(i, 0), num_in * sizeof(block));
@@ -114,10 +166,12 @@ class CMPC { public:
         check_MAC(nP, *io, ANDS_mac, ANDS_key, &ANDS_value[0], Delta, num_ands*3, party);
         check_correctness(nP, *io, &ANDS_value[0], num_ands, party);
 #endif
+        report_progress("function_independent", num_ands, num_ands);
 //        ret.get();
     }
 
     void function_dependent() {
+        TRACE_SCOPE("CMPC::function_dependent");
         int ands = num_in;
         NVec<bool> x(nP+1, num_ands);
         NVec<bool> y(nP+1, num_ands);
@@ -140,16 +194,12 @@ class CMPC { public:
                     mac.at(j, cf->gates[4*i+2]) = mac.at(j, cf->gates[4*i]) ^ mac.at(j, cf->gates[4*i+1]);
                 }
                 value[cf->gates[4*i+2]] = value[cf->gates[4*i]] != value[cf->gates[4*i+1]];
-                if(party != 1)
-                    labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ labels[cf->gates[4*i+1]];
             } else if (cf->gates[4*i+3] == NOT_GATE) {
                 for(int j = 1; j <= nP; ++j) {
                     key.at(j, cf->gates[4*i+2]) = key.at(j, cf->gates[4*i]);
                     mac.at(j, cf->gates[4*i+2]) = mac.at(j, cf->gates[4*i]);
                 }
                 value[cf->gates[4*i+2]] = value[cf->gates[4*i]];
-                if(party != 1)
-                    labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ Delta;
             }
         }
 
@@ -230,8 +280,17 @@ class CMPC { public:
         NVec<block> K(4, nP+1);
         NVec<block> M(4, nP+1);
         bool r[4];
-        if(party != 1) {
-            for(int i = 0; i < cf->num_gate; ++i) if(cf->gates[4*i+3] == AND_GATE) {
+        Vec<uint8_t> table(table_bytes());
+        if(party != evaluator) {
+            TRACE_SCOPE("CMPC::garble");
+            // AND output labels are fixed by the row-0 hash (see table_bytes),
+            // so labels are propagated in gate order while garbling
+            for(int i = 0; i < cf->num_gate; ++i) if(cf->gates[4*i+3] == XOR_GATE) {
+                labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ labels[cf->gates[4*i+1]];
+            } else if (cf->gates[4*i+3] == NOT_GATE) {
+                labels[cf->gates[4*i+2]] = labels[cf->gates[4*i]] ^ Delta;
+            } else if(cf->gates[4*i+3] == AND_GATE) {
+                report_progress("function_dependent", ands, num_ands);
                 r[0] = sigma_value[ands] != value[cf->gates[4*i+2]];
                 r[1] = r[0] != value[cf->gates[4*i]];
                 r[2] = r[0] != value[cf->gates[4*i+1]];
@@ -248,9 +307,18 @@ class CMPC { public:
                     K.at(2, j) = K.at(0, j) ^ key.at(j, cf->gates[4*i+1]);
                     K.at(3, j) = K.at(1, j) ^ key.at(j, cf->gates[4*i+1]);
                 }
-                K.at(3, 1) = K.at(3, 1) ^ Delta;
+                if(party == 1)
+                    r[3] = r[3] != true;
+                else
+                    K.at(3, 1) = K.at(3, 1) ^ Delta;
 
                 Hash(H, labels[cf->gates[4*i]], labels[cf->gates[4*i+1]], ands);
+                block L = H.at(0, party);
+                for(int k = 1; k <= nP; ++k) if(k != party)
+                    L = L ^ K.at(0, k);
+                if(r[0])
+                    L = L ^ Delta;
+                labels[cf->gates[4*i+2]] = L;
                 for(int j = 0; j < 4; ++j) {
                     for(int k = 1; k <= nP; ++k) if(k != party) {
                         H.at(j, k) = H.at(j, k) ^ M.at(j, k);
@@ -260,24 +328,50 @@ class CMPC { public:
                     if(r[j])
                         H.at(j, party) = H.at(j, party) ^ Delta;
                 }
-                for(int j = 0; j < 4; ++j)
-                    get_send_channel(*io, 1).send_data(&H.at(j, 1), sizeof(block)*(nP));
+                uint8_t * p = &table[0];
+                for(int j = 0; j < 4; ++j) {
+                    memcpy(p, &H.at(j, evaluator), SSP);
+                    p += SSP;
+                    for(int k = 1; k <= nP; ++k) if(k != evaluator and (j != 0 or k != party)) {
+                        memcpy(p, &H.at(j, k), sizeof(block));
+                        p += sizeof(block);
+                    }
+                }
+                get_send_channel(*io, evaluator).send_data(&table[0], table_bytes());
                 ++ands;
             }
-            io->flush(1);
+            io->flush(evaluator);
+            report_progress("function_dependent", num_ands, num_ands);
         } else {
-            for(int i = 2; i <= nP; ++i) {
+            TRACE_SCOPE("CMPC::recv_tables");
+            // M, K and one table per garbler, padded to whole cache lines
+            row_blocks = ((size_t)(nP+1)*(nP+1) + 3) / 4 * 4;
+            GT.alloc((size_t)num_ands*4*row_blocks, spill_threshold);
+            // counts the tables received from all garblers
+            int64_t received = 0, expected = (int64_t)(nP-1)*num_ands;
+            for(int i = 1; i <= nP; ++i) if(i != evaluator) {
                 int party2 = i;
-                for(int i = 0; i < num_ands; ++i)
-                    for(int j = 0; j < 4; ++j)
-                        get_recv_channel(*io, party2).recv_data(&GT.at(i, party2, j, 1), sizeof(block)*(nP));
+                for(int a = 0; a < num_ands; ++a) {
+                    report_progress("function_dependent", received++, expected);
+                    get_recv_channel(*io, party2).recv_data(&table[0], table_bytes());
+                    const uint8_t * p = &table[0];
+                    for(int j = 0; j < 4; ++j) {
+                        block * T = gate_row(a, j) + table_offset(party2);
+                        memcpy(&T[evaluator], p, SSP);
+                        p += SSP;
+                        for(int k = 1; k <= nP; ++k) if(k != evaluator and (j != 0 or k != party2)) {
+                            memcpy(&T[k], p, sizeof(block));
+                            p += sizeof(block);
+                        }
+                    }
+                }
             }
+            report_progress("function_dependent", expected, expected);
             for(int i = 0; i < cf->num_gate; ++i) if(cf->gates[4*i+3] == AND_GATE) {
                 r[0] = sigma_value[ands] != value[cf->gates[4*i+2]];
                 r[1] = r[0] != value[cf->gates[4*i]];
                 r[2] = r[0] != value[cf->gates[4*i+1]];
                 r[3] = r[1] != value[cf->gates[4*i+1]];
-                r[3] = r[3] != true;
 
                 for(int j = 1; j <= nP; ++j) {
                     M.at(0, j) = sigma_mac.at(j, ands) ^ mac.at(j, cf->gates[4*i+2]);
@@ -290,13 +384,39 @@ class CMPC { public:
                     K.at(2, j) = K.at(0, j) ^ key.at(j, cf->gates[4*i+1]);
                     K.at(3, j) = K.at(1, j) ^ key.at(j, cf->gates[4*i+1]);
                 }
-                memcpy(&GTK.at(ands, 0, 0), &K.at(0, 0), sizeof(block)*4*(nP+1));
-                memcpy(&GTM.at(ands, 0, 0), &M.at(0, 0), sizeof(block)*4*(nP+1));
-                memcpy(&GTv.at(ands, 0), r, sizeof(bool)*4);
+                if(party == 1)
+                    r[3] = r[3] != true;
+                else
+                    K.at(3, 1) = K.at(3, 1) ^ Delta;
+                for(int j = 0; j < 4; ++j) {
+                    block * R = gate_row(ands, j);
+                    memcpy(R, &M.at(j, 0), sizeof(block)*(nP+1));
+                    memcpy(R + nP+1, &K.at(j, 0), sizeof(block)*(nP+1));
+                    R[0] = makeBlock(0, r[j]);
+                }
                 ++ands;
             }
         }
     }
+    // Everything online needs for row `row` of AND gate `a`, so that the one
+    // row the evaluator selects is a single contiguous read:
+    //   [0, nP]             MACs M[k]; slot 0 holds the masked output bit
+    //   [nP+1, 2nP+1]       keys K[k]
+    //   table_offset(j)...  garbler j's row, nP+1 blocks indexed by party
+    // Rows start on a cache line.
+    block * gate_row(int a, int row) { return &GT[((size_t)a*4 + row)*row_blocks]; }
+    int table_offset(int garbler) const {
+        return (2 + garbler - (garbler > evaluator ? 2 : 1)) * (nP+1);
+    }
+
+    // Bytes per AND gate in each garbler's table. Every row holds the MAC
+    // entry for the evaluator truncated to SSP bytes, followed by full blocks for
+    // the other parties. The garbler picks its AND output label so that its own
+    // entry in row 0 is zero (as in GRR3), and that entry is not sent.
+    int64_t table_bytes() const {
+        return 4*SSP + (4*(nP-1)-1)*sizeof(block);
+    }
+
     void Hash(NVec<block>& H, const block & a, const block & b, uint64_t idx) {
         block T[4];
         T[0] = sigma(a);
@@ -330,46 +450,55 @@ class CMPC { public:
     }
 
     void online (FlexIn* input, FlexOut* output) {
+        TRACE_SCOPE("CMPC::online");
+        report_progress("online", 0, cf->num_gate);
         bool * mask_input = new bool[cf->num_wire];
         input->associate_cmpc(&value[0], mac, key, io, Delta);
         input->input(mask_input);
 
-        if(party!= 1) {
+        if(party != evaluator) {
             for(int i = 0; i < num_in; ++i) {
                 block tmp = labels[i];
                 if(mask_input[i]) tmp = tmp ^ Delta;
-                get_send_channel(*io, 1).send_data(&tmp, sizeof(block));
+                get_send_channel(*io, evaluator).send_data(&tmp, sizeof(block));
             }
-            io->flush(1);
+            io->flush(evaluator);
         } else {
-            for(int i = 2; i <= nP; ++i) {
+            TRACE_SCOPE("CMPC::evaluate");
+            for(int i = 1; i <= nP; ++i) if(i != evaluator) {
                 int party2 = i;
                 get_recv_channel(*io, party2).recv_data(&eval_labels.at(party2, 0), num_in*sizeof(block));
             }
 
             int ands = 0;
+            // Hash overwrites it for every gate and party
+            Vec<block> H(nP+1);
             for(int i = 0; i < cf->num_gate; ++i) {
+                report_progress("online", i, cf->num_gate);
                 if (cf->gates[4*i+3] == XOR_GATE) {
-                    for(int j = 2; j<= nP; ++j)
+                    for(int j = 1; j<= nP; ++j) if(j != evaluator)
                         eval_labels.at(j, cf->gates[4*i+2]) = eval_labels.at(j, cf->gates[4*i]) ^ eval_labels.at(j, cf->gates[4*i+1]);
                     mask_input[cf->gates[4*i+2]] = mask_input[cf->gates[4*i]] != mask_input[cf->gates[4*i+1]];
                 } else if (cf->gates[4*i+3] == AND_GATE) {
                     int index = 2*mask_input[cf->gates[4*i]] + mask_input[cf->gates[4*i+1]];
-                    Vec<block> H(nP+1);
-                    for(int j = 2; j <= nP; ++j)
-                        eval_labels.at(j, cf->gates[4*i+2]) = GTM.at(ands, index, j);
-                    mask_input[cf->gates[4*i+2]] = GTv.at(ands, index);
-                    for(int j = 2; j <= nP; ++j) {
+                    const block * R = gate_row(ands, index);
+                    const block * RK = R + nP+1;
+                    for(int j = 1; j <= nP; ++j) if(j != evaluator)
+                        eval_labels.at(j, cf->gates[4*i+2]) = R[j];
+                    mask_input[cf->gates[4*i+2]] = getLSB(R[0]);
+                    for(int j = 1; j <= nP; ++j) if(j != evaluator) {
                         Hash(&H.at(0), eval_labels.at(j, cf->gates[4*i]), eval_labels.at(j, cf->gates[4*i+1]), ands, index);
-                        xorBlocks_arr(&H.at(0), &H.at(0), &GT.at(ands, j, index, 0), nP+1);
-                        for(int k = 2; k <= nP; ++k)
+                        xorBlocks_arr(&H.at(0), &H.at(0), R + table_offset(j), nP+1);
+                        for(int k = 1; k <= nP; ++k) if(k != evaluator)
                             eval_labels.at(k, cf->gates[4*i+2]) = H.at(k) ^ eval_labels.at(k, cf->gates[4*i+2]);
 
-                        block t0 = GTK.at(ands, index, j) ^ Delta;
+                        block t0 = (RK[j] ^ Delta) & MASK;
+                        block t1 = RK[j] & MASK;
+                        H.at(evaluator) = H.at(evaluator) & MASK;
 
-                        if(cmpBlock(&H.at(1), &GTK.at(ands, index, j), 1))
+                        if(cmpBlock(&H.at(evaluator), &t1, 1))
                             mask_input[cf->gates[4*i+2]] = mask_input[cf->gates[4*i+2]] != false;
-                        else if(cmpBlock(&H.at(1), &t0, 1))
+                        else if(cmpBlock(&H.at(evaluator), &t0, 1))
                             mask_input[cf->gates[4*i+2]] = mask_input[cf->gates[4*i+2]] != true;
                         else {
                             throw std::runtime_error("no match GT!");
@@ -378,16 +507,17 @@ class CMPC { public:
                     ands++;
                 } else {
                     mask_input[cf->gates[4*i+2]] = not mask_input[cf->gates[4*i]];
-                    for(int j = 2; j <= nP; ++j)
+                    for(int j = 1; j <= nP; ++j) if(j != evaluator)
                         eval_labels.at(j, cf->gates[4*i+2]) = eval_labels.at(j, cf->gates[4*i]);
                 }
             }
         }
 
-        output->associate_cmpc(&value[0], mac, key, eval_labels, labels, io, Delta);
+        output->associate_cmpc(&value[0], mac, key, eval_labels, labels, io, Delta, evaluator);
         output->output(mask_input, cf->num_wire - cf->n3);
 
         delete[] mask_input;
+        report_progress("online", cf->num_gate, cf->num_gate);
     }
 };
 #endif// CMPC_H
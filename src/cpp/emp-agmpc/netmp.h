@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <emp-tool/emp-tool.h>
 #include <emp-tool/io/net_io.h>
+#include <emp-tool/io/simulated_wan.h>
 #include "cmpc_config.h"
 #include "vec.h"
 using namespace emp;
@@ -14,18 +15,27 @@ private:
     Vec<std::optional<IOChannel>> a_channels;
     Vec<std::optional<IOChannel>> b_channels;
     int mParty;
+    std::optional<WANConfig> wan;
 
-    std::shared_ptr<NetIO> make_net_io(const char * address, int port) {
-        return std::make_shared<NetIO>(address, port);
+    std::shared_ptr<IRawIO> make_net_io(const char * address, int port) {
+        auto net_io = std::make_shared<NetIO>(address, port);
+        if(!wan)
+            return net_io;
+        // each end of each link draws its own jitter
+        WANConfig config = *wan;
+        config.seed ^= ((uint64_t)port << 8) | mParty;
+        return std::make_shared<SimulatedWAN>(net_io, config);
     }
 
 public:
-    NetIOMP(int nP, int party, int port)
+    // with `wan`, every link is slowed down as if it were one, see SimulatedWAN
+    NetIOMP(int nP, int party, int port, std::optional<WANConfig> wan = std::nullopt)
     :
         nP(nP),
         a_channels(nP+1),
         b_channels(nP+1),
-        mParty(party)
+        mParty(party),
+        wan(wan)
     {
         for(int i = 1; i <= nP; ++i)for(int j = 1; j <= nP; ++j)if(i < j){
             if(i == party) {
@@ -62,6 +72,9 @@ public:
 #endif
             }
         }
+        for(int i = 1; i <= nP; ++i)
+            if(i != party)
+                b_channels[i]->share_rounds(*a_channels[i]);
     }
 
     int party() override {
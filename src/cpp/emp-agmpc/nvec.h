@@ -6,10 +6,14 @@
 #include <numeric>
 #include <cstddef>
 #include <utility>
+#include <vector>
+#include <cstring>
 
-#include "vec.h"
+#include "emp-tool/utils/aligned_buffer.h"
+#include "emp-tool/utils/arena.h"
 
-// N-dimensional vector class
+// N-dimensional vector class, over zeroed, cache line aligned storage (see
+// AlignedBuffer). Move-only: pass it by reference.
 template <typename T>
 class NVec {
 public:
@@ -22,17 +26,21 @@ public:
         resize(dims...);
     }
 
-    // Resize method
+    // Zeroed storage from an arena, which must outlive it; for temporaries
     template <typename... Dims>
-    void resize(Dims... dims) {
-        // Store the sizes of each dimension
-        dimensions = {static_cast<size_t>(dims)...};
+    NVec(emp::Arena& arena, Dims... dims) {
+        set_dimensions(dims...);
+        data = emp::AlignedBuffer<T>::view(arena.alloc<T>(total_size), total_size);
+        memset(data.data(), 0, data.bytes());
+    }
 
-        // Calculate the total size of the data
-        total_size = std::accumulate(dimensions.begin(), dimensions.end(), 1ull, std::multiplies<>());
+    // Resize method; the old contents are dropped
+    template <typename... Dims>
+    void resize(Dims... dims) {
+        set_dimensions(dims...);
 
         // Allocate the storage
-        data.resize(total_size);
+        data = emp::AlignedBuffer<T>(total_size);
     }
 
     // Access element with variadic indices
@@ -44,7 +52,7 @@ public:
         }
 
         size_t flat_index = compute_flat_index({static_cast<size_t>(indices)...});
-        return data.at(flat_index);
+        return data[flat_index];
     }
 
     // Const access
@@ -56,13 +64,22 @@ public:
         }
 
         size_t flat_index = compute_flat_index({static_cast<size_t>(indices)...});
-        return data.at(flat_index);
+        return data[flat_index];
     }
 
 private:
     std::vector<size_t> dimensions; // Sizes of each dimension
     size_t total_size;              // Total size of the data
-    Vec<T> data;                    // Linear storage for the elements
+    emp::AlignedBuffer<T> data;     // Linear storage for the elements
+
+    template <typename... Dims>
+    void set_dimensions(Dims... dims) {
+        // Store the sizes of each dimension
+        dimensions = {static_cast<size_t>(dims)...};
+
+        // Calculate the total size of the data
+        total_size = std::accumulate(dimensions.begin(), dimensions.end(), 1ull, std::multiplies<>());
+    }
 
     // Compute the flat index from multi-dimensional indices
     size_t compute_flat_index(const std::vector<size_t>& indices) const {
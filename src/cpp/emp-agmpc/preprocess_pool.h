@@ -0,0 +1,209 @@
+#ifndef EMP_AGMPC_PREPROCESS_POOL_H
+#define EMP_AGMPC_PREPROCESS_POOL_H
+
+#include <istream>
+#include <ostream>
+
+#include <emp-tool/emp-tool.h>
+#include "fpremp.h"
+#include "helper.h"
+#include "nvec.h"
+#include "vec.h"
+
+using namespace emp;
+
+// Authenticated AND triples and authenticated bits generated ahead of a
+// circuit run, so that CMPC::function_independent only has to copy them out.
+//
+// All parties generate a pool together and must consume it in lockstep:
+// before anything is taken the pool id and cursors are compared between
+// parties. The pool contains this party's Delta and MAC keys, so a saved
+// pool must be kept as secret as the party's inputs.
+class PreprocessPool { public:
+    const static uint32_t MAGIC = 0x504d5045; // "EMPP"
+    const static uint32_t VERSION = 1;
+
+    int nP = 0;
+    int party = 0;
+    int ssp = 40;
+    bool delta_bits[128] = {};
+    block Delta = zero_block;
+    block id = zero_block;
+
+    int64_t num_ands = 0, ands_used = 0;
+    NVec<block> ANDS_mac; // dim: parties, num_ands*3
+    NVec<block> ANDS_key; // dim: parties, num_ands*3
+    Vec<bool> ANDS_value; // dim: num_ands*3
+
+    int64_t num_abits = 0, abits_used = 0;
+    NVec<block> abit_mac; // dim: parties, num_abits
+    NVec<block> abit_key; // dim: parties, num_abits
+    Vec<bool> abit_value; // dim: num_abits
+
+    // Runs the function-independent preprocessing for `ands` AND gates and
+    // `abits` wire masks. Replaces whatever the pool held before.
+    void generate(std::shared_ptr<IMultiIO>& io, int64_t ands, int64_t abits, int ssp = 40) {
+        TRACE_SCOPE("PreprocessPool::generate");
+        nP = io->size();
+        party = io->party();
+        this->ssp = ssp;
+
+        PRG prg;
+        prg.random_bool(delta_bits, 128);
+        FpreMP fpre(io, delta_bits, ssp);
+        Delta = fpre.Delta;
+
+        num_ands = ands;
+        ANDS_mac.resize(nP+1, num_ands*3);
+        ANDS_key.resize(nP+1, num_ands*3);
+        ANDS_value.resize(num_ands*3);
+        if(num_ands > 0)
+            fpre.compute(ANDS_mac, ANDS_key, &ANDS_value[0], num_ands);
+
+        // the last 3*ssp bits are sacrificed by the abit check
+        num_abits = abits;
+        NVec<block> tMAC(nP+1, num_abits + 3*ssp);
+        NVec<block> tKEY(nP+1, num_abits + 3*ssp);
+        Vec<bool> tvalue(num_abits + 3*ssp);
+        prg.random_bool(&tvalue[0], num_abits + 3*ssp);
+        fpre.abit->compute(tMAC, tKEY, &tvalue[0], num_abits + 3*ssp);
+        fpre.abit->check(tMAC, tKEY, &tvalue[0], num_abits + 3*ssp);
+
+        abit_mac.resize(nP+1, num_abits);
+        abit_key.resize(nP+1, num_abits);
+        abit_value.resize(num_abits);
+        if(num_abits > 0) {
+            for(int i = 1; i <= nP; ++i) if(i != party) {
+                memcpy(&abit_mac.at(i, 0), &tMAC.at(i, 0), num_abits * sizeof(block));
+                memcpy(&abit_key.at(i, 0), &tKEY.at(i, 0), num_abits * sizeof(block));
+            }
+            memcpy(&abit_value[0], &tvalue[0], num_abits * sizeof(bool));
+        }
+
+        id = sampleRandom(nP, *io, &prg, party);
+        ands_used = 0;
+        abits_used = 0;
+    }
+
+    int64_t ands_left() const { return num_ands - ands_used; }
+    int64_t abits_left() const { return num_abits - abits_used; }
+
+    // Checks that every party is about to consume the same part of the same pool.
+    void sync(IMultiIO& io) {
+        char dgst[Hash::DIGEST_SIZE];
+        Hash h;
+        h.put(&id, sizeof(block));
+        h.put(&ands_used, sizeof(int64_t));
+        h.put(&abits_used, sizeof(int64_t));
+        h.digest(dgst);
+
+        vector<bool> res;
+        for(int i = 1; i <= nP; ++i) for(int j = 1; j<= nP; ++j) if( (i < j) and (i == party or j == party) ) {
+            int party2 = i + j - party;
+            char tmp[Hash::DIGEST_SIZE];
+            get_send_channel(io, party2).send_data(dgst, Hash::DIGEST_SIZE);
+            io.flush(party2);
+            get_recv_channel(io, party2).recv_data(tmp, Hash::DIGEST_SIZE);
+            res.push_back(memcmp(tmp, dgst, Hash::DIGEST_SIZE) != 0);
+        }
+        if(checkCheat(res)) error("preprocess pool out of sync");
+    }
+
+    void take_ands(NVec<block>& MAC, NVec<block>& KEY, bool* r, int64_t length) {
+        if(length > ands_left()) error("preprocess pool is out of AND triples");
+        if(length == 0) return;
+        for(int i = 1; i <= nP; ++i) if(i != party) {
+            memcpy(&MAC.at(i, 0), &ANDS_mac.at(i, 3*ands_used), 3*length * sizeof(block));
+            memcpy(&KEY.at(i, 0), &ANDS_key.at(i, 3*ands_used), 3*length * sizeof(block));
+        }
+        memcpy(r, &ANDS_value[3*ands_used], 3*length * sizeof(bool));
+        ands_used += length;
+    }
+
+    void take_abits(NVec<block>& MAC, NVec<block>& KEY, bool* r, int64_t length) {
+        if(length > abits_left()) error("preprocess pool is out of authenticated bits");
+        if(length == 0) return;
+        for(int i = 1; i <= nP; ++i) if(i != party) {
+            memcpy(&MAC.at(i, 0), &abit_mac.at(i, abits_used), length * sizeof(block));
+            memcpy(&KEY.at(i, 0), &abit_key.at(i, abits_used), length * sizeof(block));
+        }
+        memcpy(r, &abit_value[abits_used], length * sizeof(bool));
+        abits_used += length;
+    }
+
+    void save(std::ostream& out) const {
+        uint32_t header[2] = {MAGIC, VERSION};
+        int32_t params[3] = {nP, party, ssp};
+        int64_t counts[4] = {num_ands, ands_used, num_abits, abits_used};
+        out.write((const char*)header, sizeof(header));
+        out.write((const char*)params, sizeof(params));
+        out.write((const char*)delta_bits, sizeof(delta_bits));
+        out.write((const char*)&Delta, sizeof(block));
+        out.write((const char*)&id, sizeof(block));
+        out.write((const char*)counts, sizeof(counts));
+
+        for(int i = 1; i <= nP; ++i) if(i != party) {
+            if(num_ands > 0) {
+                out.write((const char*)&ANDS_mac.at(i, 0), 3*num_ands * sizeof(block));
+                out.write((const char*)&ANDS_key.at(i, 0), 3*num_ands * sizeof(block));
+            }
+            if(num_abits > 0) {
+                out.write((const char*)&abit_mac.at(i, 0), num_abits * sizeof(block));
+                out.write((const char*)&abit_key.at(i, 0), num_abits * sizeof(block));
+            }
+        }
+        if(num_ands > 0)
+            out.write((const char*)&ANDS_value[0], 3*num_ands * sizeof(bool));
+        if(num_abits > 0)
+            out.write((const char*)&abit_value[0], num_abits * sizeof(bool));
+        if(!out) error("failed to write preprocess pool");
+    }
+
+    void load(std::istream& in) {
+        uint32_t header[2];
+        int32_t params[3];
+        int64_t counts[4];
+        in.read((char*)header, sizeof(header));
+        if(!in || header[0] != MAGIC) error("not a preprocess pool");
+        if(header[1] != VERSION) error("unsupported preprocess pool version");
+        in.read((char*)params, sizeof(params));
+        in.read((char*)delta_bits, sizeof(delta_bits));
+        in.read((char*)&Delta, sizeof(block));
+        in.read((char*)&id, sizeof(block));
+        in.read((char*)counts, sizeof(counts));
+        if(!in) error("truncated preprocess pool");
+
+        nP = params[0];
+        party = params[1];
+        ssp = params[2];
+        num_ands = counts[0];
+        ands_used = counts[1];
+        num_abits = counts[2];
+        abits_used = counts[3];
+
+        ANDS_mac.resize(nP+1, num_ands*3);
+        ANDS_key.resize(nP+1, num_ands*3);
+        ANDS_value.resize(num_ands*3);
+        abit_mac.resize(nP+1, num_abits);
+        abit_key.resize(nP+1, num_abits);
+        abit_value.resize(num_abits);
+
+        for(int i = 1; i <= nP; ++i) if(i != party) {
+            if(num_ands > 0) {
+                in.read((char*)&ANDS_mac.at(i, 0), 3*num_ands * sizeof(block));
+                in.read((char*)&ANDS_key.at(i, 0), 3*num_ands * sizeof(block));
+            }
+            if(num_abits > 0) {
+                in.read((char*)&abit_mac.at(i, 0), num_abits * sizeof(block));
+                in.read((char*)&abit_key.at(i, 0), num_abits * sizeof(block));
+            }
+        }
+        if(num_ands > 0)
+            in.read((char*)&ANDS_value[0], 3*num_ands * sizeof(bool));
+        if(num_abits > 0)
+            in.read((char*)&abit_value[0], num_abits * sizeof(bool));
+        if(!in) error("truncated preprocess pool");
+    }
+};
+
+#endif// EMP_AGMPC_PREPROCESS_POOL_H
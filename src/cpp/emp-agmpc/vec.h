@@ -10,12 +10,21 @@
 // Like std::vector but without <bool> specialization.
 // This is important because std::vector<bool> is a bitset which breaks assumptions
 // made by code designed for bool* arrays.
+// It can also view storage it does not own (an arena's, say); growing such a
+// Vec, or copying it, moves the elements to storage of its own.
 template <typename T>
 class Vec {
 private:
     T* data;          // Raw pointer to the array
     size_t capacity;  // Allocated capacity
     size_t size_;     // Current size
+    bool owned = true; // whether data was allocated here
+
+    void free_data() {
+        if (owned) {
+            delete[] data;
+        }
+    }
 
     void grow(size_t new_capacity = 0) {
         if (new_capacity == 0) {
@@ -25,9 +34,10 @@ private:
         for (size_t i = 0; i < size_; ++i) {
             new_data[i] = std::move(data[i]);
         }
-        delete[] data;
+        free_data();
         data = new_data;
         capacity = new_capacity;
+        owned = true;
     }
 
 public:
@@ -39,7 +49,14 @@ public:
             data[i] = value;
         }
     }
-    ~Vec() { delete[] data; }
+    // Views n elements at external, which must outlive it
+    Vec(T* external, size_t n, const T& value = T())
+        : data(external), capacity(n), size_(n), owned(false) {
+        for (size_t i = 0; i < n; ++i) {
+            data[i] = value;
+        }
+    }
+    ~Vec() { free_data(); }
 
     // Copy constructor
     Vec(const Vec& other)
@@ -51,7 +68,7 @@ public:
 
     // Move constructor
     Vec(Vec&& other) noexcept
-        : data(other.data), capacity(other.capacity), size_(other.size_) {
+        : data(other.data), capacity(other.capacity), size_(other.size_), owned(other.owned) {
         other.data = nullptr;
         other.capacity = 0;
         other.size_ = 0;
@@ -60,8 +77,9 @@ public:
     // Copy assignment
     Vec& operator=(const Vec& other) {
         if (this != &other) {
-            delete[] data;
+            free_data();
             data = new T[other.capacity];
+            owned = true;
             capacity = other.capacity;
             size_ = other.size_;
             for (size_t i = 0; i < size_; ++i) {
@@ -74,10 +92,11 @@ public:
     // Move assignment
     Vec& operator=(Vec&& other) noexcept {
         if (this != &other) {
-            delete[] data;
+            free_data();
             data = other.data;
             capacity = other.capacity;
             size_ = other.size_;
+            owned = other.owned;
             other.data = nullptr;
             other.capacity = 0;
             other.size_ = 0;
@@ -140,7 +159,7 @@ public:
     bool empty() const { return size_ == 0; }
 
     void clear() {
-        delete[] data;
+        free_data();
         data = nullptr;
         capacity = 0;
         size_ = 0;
@@ -41,6 +41,7 @@ public:
     }
 
     void setup_send(const bool* in_s = nullptr, block * in_k0 = nullptr) {
+        TRACE_SCOPE("IKNP::setup_send");
         setup = true;
         if(in_s == nullptr)
             prg.random_bool(s, 128);
@@ -61,6 +62,7 @@ public:
     }
 
     void setup_recv(block * in_k0 = nullptr, block * in_k1 =nullptr) {
+        TRACE_SCOPE("IKNP::setup_recv");
         setup = true;
         if(in_k0 !=nullptr) {
             memcpy(k0, in_k0, 128*sizeof(block));
@@ -79,6 +81,7 @@ public:
     }
 
     void send_pre(block * out, int64_t length) {
+        TRACE_SCOPE("IKNP::send_pre");
         if(not setup)
             setup_send();
         int64_t j = 0;
@@ -108,6 +111,7 @@ public:
     }
 
     void recv_pre(block * out, const bool* r, int64_t length) {
+        TRACE_SCOPE("IKNP::recv_pre");
         if(not setup)
             setup_recv();
 
@@ -220,6 +224,7 @@ public:
  * https://eprint.iacr.org/2015/546.pdf
  */
     bool send_check(block * out, int64_t length) {
+        TRACE_SCOPE("IKNP::send_check");
         block seed2, x, t[2], q[2], tmp[2];
         block chi[block_size];
         q[0] = q[1] = makeBlock(0, 0);
@@ -256,6 +261,7 @@ public:
         return cmpBlock(q, t, 2);
     }
     void recv_check(block * out, const bool* r, int64_t length) {
+        TRACE_SCOPE("IKNP::recv_check");
         block select[2] = {zero_block, all_one_block};
         block seed2, x = makeBlock(0,0), t[2], tmp[2];
         prg.random_block(&seed2,1);
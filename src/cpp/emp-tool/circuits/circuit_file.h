@@ -161,6 +161,55 @@ public:
             throw std::runtime_error("Extra bytes after final gate");
     }
 
+    // The inverse of from_buffer, in the same layout as bristolToBinary.
+    std::vector<uint8_t> to_buffer() const {
+        size_t size = 20;
+        for (int g = 0; g < num_gate; ++g)
+            size += gates[4 * g + 3] == NOT_GATE ? 9 : 13;
+
+        std::vector<uint8_t> buf(size);
+        uint8_t* p = buf.data();
+        auto write_u32 = [&](uint32_t v) {
+            p[0] = v & 0xff;
+            p[1] = (v >> 8) & 0xff;
+            p[2] = (v >> 16) & 0xff;
+            p[3] = (v >> 24) & 0xff;
+            p += 4;
+        };
+
+        for (int v : {num_gate, num_wire, n1, n2, n3})
+            write_u32(v);
+
+        for (int g = 0; g < num_gate; ++g) {
+            const int* gate = &gates[4 * g];
+            if (gate[3] == NOT_GATE) {
+                *p++ = 0;
+                write_u32(gate[0]);
+            } else {
+                *p++ = gate[3] == XOR_GATE ? 1 : 2;
+                write_u32(gate[0]);
+                write_u32(gate[1]);
+            }
+            write_u32(gate[2]);
+        }
+
+        return buf;
+    }
+
+    // Writes the circuit as Bristol text, as read by from_file.
+    void to_bristol(std::ostream& out) const {
+        out << num_gate << " " << num_wire << "\n";
+        out << n1 << " " << n2 << " " << n3 << "\n\n";
+        for (int g = 0; g < num_gate; ++g) {
+            const int* gate = &gates[4 * g];
+            if (gate[3] == NOT_GATE)
+                out << "1 1 " << gate[0] << " " << gate[2] << " INV\n";
+            else
+                out << "2 1 " << gate[0] << " " << gate[1] << " " << gate[2]
+                    << (gate[3] == XOR_GATE ? " XOR\n" : " AND\n");
+        }
+    }
+
     void compute(Bit* out, const Bit* in1, const Bit* in2) {
         compute((block*)out, (block*)in1, (block*)in2);
     }
@@ -210,6 +259,9 @@ private:
 class BristolFashion { public:
     int num_gate = 0, num_wire = 0,
          num_input = 0, num_output = 0;
+    // sizes of the input and output wire groups, in wire order (usually
+    // one group per party)
+    vector<int> input_sizes, output_sizes;
     vector<int> gates;
     vector<block> wires;
 
@@ -229,11 +281,13 @@ class BristolFashion { public:
         for(int i = 0; i < niov; ++i) {
             (void)fscanf(f, "%d", &tmp);
             num_input += tmp;
+            input_sizes.push_back(tmp);
         }
         (void)fscanf(f, "%d", &niov);
         for(int i = 0; i < niov; ++i) {
             (void)fscanf(f, "%d", &tmp);
             num_output += tmp;
+            output_sizes.push_back(tmp);
         }
 
         char str[10];
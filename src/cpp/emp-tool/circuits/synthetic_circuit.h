@@ -0,0 +1,121 @@
+#ifndef EMP_SYNTHETIC_CIRCUIT_H
+#define EMP_SYNTHETIC_CIRCUIT_H
+
+#include "emp-tool/circuits/circuit_file.h"
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace emp {
+
+// Shape of a generated circuit. The ANDs are split into `depth` layers (or
+// layers of `width` ANDs, if depth is 0) and every AND takes one input from
+// the layer before, so the AND depth is exactly the number of layers. Each
+// layer starts with its share of the XOR gates, which mix wires of the
+// previous layer. The outputs are the last n3 gates.
+struct SyntheticCircuitSpec {
+    int64_t num_and = 1000;
+    double xor_ratio = 1.0; // XOR gates per AND gate
+    int64_t depth = 0;
+    int64_t width = 64;
+    int n1 = 64, n2 = 64, n3 = 64;
+    uint64_t seed = 1;
+
+    int64_t layers() const {
+        if (depth > 0)
+            return std::min(depth, num_and);
+        return (num_and + width - 1) / width;
+    }
+
+    int64_t num_xor() const {
+        return llround(num_and * xor_ratio);
+    }
+
+    int64_t num_gate() const {
+        return num_and + num_xor();
+    }
+
+    int64_t num_wire() const {
+        return n1 + n2 + num_gate();
+    }
+
+    void check() const {
+        if (num_and < 1 or xor_ratio < 0 or depth < 0 or (depth == 0 and width < 1))
+            throw std::invalid_argument("synthetic circuit: bad shape");
+        if (n1 < 0 or n2 < 0 or n1 + n2 < 1 or n3 < 0 or n3 > num_gate())
+            throw std::invalid_argument("synthetic circuit: bad input or output size");
+        if (num_wire() > INT_MAX)
+            throw std::invalid_argument("synthetic circuit: too many wires");
+    }
+};
+
+// Calls emit(in1, in2, out, type) for each gate in order, with type one of
+// AND_GATE and XOR_GATE. Gates are streamed, so circuits too large to hold
+// as a BristolFormat can still be written out. The same spec always gives
+// the same circuit.
+template<typename F>
+void generate_synthetic_circuit(const SyntheticCircuitSpec& spec, F&& emit) {
+    spec.check();
+
+    uint64_t state = spec.seed;
+    // splitmix64, so the circuit does not depend on the standard library
+    auto next = [&]() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    };
+    auto pick = [&](const std::vector<int>& from) {
+        return from[next() % from.size()];
+    };
+
+    int64_t layers = spec.layers();
+    int64_t num_xor = spec.num_xor();
+    int wire = spec.n1 + spec.n2;
+
+    std::vector<int> prev, mixed, cur;
+    for (int i = 0; i < wire; ++i)
+        prev.push_back(i);
+
+    for (int64_t l = 0; l < layers; ++l) {
+        int64_t ands = spec.num_and / layers + (l < spec.num_and % layers);
+        int64_t xors = num_xor / layers + (l < num_xor % layers);
+
+        mixed = prev;
+        for (int64_t i = 0; i < xors; ++i) {
+            emit(pick(prev), pick(mixed), wire, XOR_GATE);
+            mixed.push_back(wire++);
+        }
+
+        cur.clear();
+        for (int64_t i = 0; i < ands; ++i) {
+            emit(prev[i % prev.size()], pick(mixed), wire, AND_GATE);
+            cur.push_back(wire++);
+        }
+        std::swap(prev, cur);
+    }
+}
+
+inline BristolFormat synthetic_circuit(const SyntheticCircuitSpec& spec) {
+    spec.check();
+
+    BristolFormat cf;
+    cf.num_gate = spec.num_gate();
+    cf.num_wire = spec.num_wire();
+    cf.n1 = spec.n1;
+    cf.n2 = spec.n2;
+    cf.n3 = spec.n3;
+    cf.gates.reserve(4 * (size_t)cf.num_gate);
+    cf.wires.resize(cf.num_wire);
+
+    generate_synthetic_circuit(spec, [&](int in1, int in2, int out, int type) {
+        cf.gates.insert(cf.gates.end(), {in1, in2, out, type});
+    });
+
+    return cf;
+}
+
+}
+#endif// EMP_SYNTHETIC_CIRCUIT_H
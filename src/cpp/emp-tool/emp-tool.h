@@ -6,6 +6,7 @@ using std::min;
 #include "emp-tool/io/io_channel.h"
 
 #include "emp-tool/circuits/circuit_file.h"
+#include "emp-tool/circuits/synthetic_circuit.h"
 
 #include "emp-tool/utils/block.h"
 #include "emp-tool/utils/constants.h"
@@ -19,6 +20,13 @@ using std::min;
 #include "emp-tool/utils/aes_opt.h"
 #include "emp-tool/utils/aes.h"
 #include "emp-tool/utils/f2k.h"
+#include "emp-tool/utils/bucketing.h"
+#include "emp-tool/utils/spill_buffer.h"
+#include "emp-tool/utils/trace.h"
+#include "emp-tool/utils/progress.h"
+#include "emp-tool/utils/mem_account.h"
+#include "emp-tool/utils/arena.h"
+#include "emp-tool/utils/aligned_buffer.h"
 
 #include "emp-tool/gc/halfgate_eva.h"
 #include "emp-tool/gc/halfgate_gen.h"
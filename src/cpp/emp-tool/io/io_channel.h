@@ -11,18 +11,34 @@ namespace emp {
 class IOChannel {
 private:
     std::shared_ptr<IRawIO> raw_io;
+    std::shared_ptr<bool> sending = std::make_shared<bool>(false);
 
 public:
     std::shared_ptr<uint64_t> counter = std::make_shared<uint64_t>(0);
+    // number of send flights: sends that follow a receive (or start the
+    // channel), i.e. how often this side had to wait for the other
+    std::shared_ptr<uint64_t> rounds = std::make_shared<uint64_t>(0);
 
     IOChannel(std::shared_ptr<IRawIO> raw_io): raw_io(raw_io) {}
 
+    // Count rounds together with `other`, for when sends to a party go over
+    // one channel and its replies come back over another.
+    void share_rounds(IOChannel& other) {
+        rounds = other.rounds;
+        sending = other.sending;
+    }
+
     void send_data(const void * data, size_t nbyte) {
+        if(!*sending) {
+            ++*rounds;
+            *sending = true;
+        }
         *counter += nbyte;
         raw_io->send(data, nbyte);
     }
 
     void recv_data(void * data, size_t nbyte) {
+        *sending = false;
         raw_io->recv(data, nbyte);
     }
 
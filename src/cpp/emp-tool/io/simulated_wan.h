@@ -0,0 +1,113 @@
+#ifndef EMP_SIMULATED_WAN_H
+#define EMP_SIMULATED_WAN_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "emp-tool/io/i_raw_io.h"
+
+namespace emp {
+
+struct WANConfig {
+    double latency_ms = 0;   // one way
+    double bandwidth = 0;    // bytes per second, 0 for unlimited
+    double jitter_ms = 0;    // extra delay, uniform in [0, jitter_ms]
+    uint64_t seed = 1;
+};
+
+// Wraps an IRawIO so that data arrives as if sent over a slower link. Sends
+// are collected until the next flush (or recv, as NetIO does) and go out as
+// one frame stamped with the time it should arrive: after the link has been
+// busy len / bandwidth seconds with it, behind earlier frames, plus latency
+// and jitter. The receiving side holds each frame back until then. Both ends
+// must be wrapped, and the stamps use the steady clock, so both ends have to
+// run on the same machine. The jitter is drawn from `seed`, so runs repeat.
+class SimulatedWAN: public IRawIO {
+public:
+    SimulatedWAN(std::shared_ptr<IRawIO> inner, WANConfig config)
+        : inner(inner), config(config), rng(config.seed) {}
+
+    ~SimulatedWAN() {
+        send_frame();
+    }
+
+    void send(const void* data, size_t len) override {
+        out.insert(out.end(), (const uint8_t*)data, (const uint8_t*)data + len);
+    }
+
+    void recv(void* data, size_t len) override {
+        flush();
+        while (in.size() - in_pos < len)
+            recv_frame();
+        memcpy(data, in.data() + in_pos, len);
+        in_pos += len;
+        if (in_pos == in.size()) {
+            in.clear();
+            in_pos = 0;
+        }
+    }
+
+    void flush() override {
+        send_frame();
+        inner->flush();
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    std::shared_ptr<IRawIO> inner;
+    WANConfig config;
+    uint64_t rng;
+    std::vector<uint8_t> out, in;
+    size_t in_pos = 0;
+    int64_t busy_until = 0; // ns on the steady clock
+    int64_t last_arrival = 0;
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now().time_since_epoch()).count();
+    }
+
+    // splitmix64, uniform in [0, 1)
+    double next_uniform() {
+        uint64_t z = (rng += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return (z ^ (z >> 31)) / 18446744073709551616.0;
+    }
+
+    void send_frame() {
+        if (out.empty())
+            return;
+        int64_t now = now_ns();
+        int64_t transmit = config.bandwidth > 0 ? out.size() / config.bandwidth * 1e9 : 0;
+        busy_until = std::max(busy_until, now) + transmit;
+        int64_t arrival = busy_until + (config.latency_ms + config.jitter_ms * next_uniform()) * 1e6;
+        // jitter must not reorder frames
+        arrival = std::max(arrival, last_arrival);
+        last_arrival = arrival;
+
+        uint64_t header[2] = {(uint64_t)arrival, out.size()};
+        inner->send(header, sizeof(header));
+        inner->send(out.data(), out.size());
+        out.clear();
+    }
+
+    void recv_frame() {
+        uint64_t header[2];
+        inner->recv(header, sizeof(header));
+        size_t old_size = in.size();
+        in.resize(old_size + header[1]);
+        inner->recv(in.data() + old_size, header[1]);
+        int64_t wait = (int64_t)header[0] - now_ns();
+        if (wait > 0)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(wait));
+    }
+};
+
+}
+#endif// EMP_SIMULATED_WAN_H
@@ -0,0 +1,119 @@
+#ifndef EMP_ALIGNED_BUFFER_H
+#define EMP_ALIGNED_BUFFER_H
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#ifndef __EMSCRIPTEN__
+#include <sys/mman.h>
+#endif
+
+namespace emp {
+
+// How an AlignedBuffer starts out.
+enum class BufferInit { ZEROED, UNINITIALIZED };
+
+// Move-only array of trivially copyable T (blocks, mostly), aligned to a cache
+// line. Unlike new T[n] followed by a fill, nothing is written unless zeroing
+// is asked for. On native builds a buffer of at least LARGE bytes is an
+// anonymous mapping instead: the kernel zeroes its pages on first touch, so
+// ZEROED costs nothing up front, and it is marked for transparent huge pages
+// to cut page faults and TLB misses. The Wasm build always uses the heap.
+// A view() wraps storage owned elsewhere (an Arena's) and frees nothing.
+template<typename T>
+class AlignedBuffer {
+    static_assert(std::is_trivially_copyable<T>::value, "AlignedBuffer never constructs its elements");
+
+public:
+    const static size_t ALIGN = 64;
+    const static size_t LARGE = 2 << 20;
+
+    AlignedBuffer() {}
+
+    explicit AlignedBuffer(size_t n, BufferInit init = BufferInit::ZEROED) {
+        size_ = n;
+        if(n == 0) return;
+#ifndef __EMSCRIPTEN__
+        if(bytes() >= LARGE) {
+            void * p = mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if(p == MAP_FAILED)
+                throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+            madvise(p, bytes(), MADV_HUGEPAGE);
+#endif
+            ptr = static_cast<T*>(p);
+            kind = MAPPED;
+            return;
+        }
+#endif
+        ptr = static_cast<T*>(::operator new(bytes(), std::align_val_t(ALIGN)));
+        kind = HEAP;
+        if(init == BufferInit::ZEROED)
+            memset(ptr, 0, bytes());
+    }
+
+    static AlignedBuffer view(T* external, size_t n) {
+        AlignedBuffer b;
+        b.ptr = external;
+        b.size_ = n;
+        return b;
+    }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept {
+        take(other);
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if(this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    ~AlignedBuffer() { release(); }
+
+    void release() {
+#ifndef __EMSCRIPTEN__
+        if(kind == MAPPED)
+            munmap(ptr, bytes());
+#endif
+        if(kind == HEAP)
+            ::operator delete(ptr, std::align_val_t(ALIGN));
+        ptr = nullptr;
+        size_ = 0;
+        kind = VIEW;
+    }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    size_t size() const { return size_; }
+    size_t bytes() const { return size_ * sizeof(T); }
+    bool empty() const { return size_ == 0; }
+
+private:
+    enum Kind { VIEW, HEAP, MAPPED };
+
+    T* ptr = nullptr;
+    size_t size_ = 0;
+    Kind kind = VIEW;
+
+    void take(AlignedBuffer& other) {
+        ptr = other.ptr;
+        size_ = other.size_;
+        kind = other.kind;
+        other.ptr = nullptr;
+        other.size_ = 0;
+        other.kind = VIEW;
+    }
+};
+
+}
+#endif// EMP_ALIGNED_BUFFER_H
@@ -0,0 +1,125 @@
+#ifndef EMP_ARENA_H
+#define EMP_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "emp-tool/utils/mem_account.h"
+
+namespace emp {
+
+// Bump allocator for the temporaries of a phase. alloc() hands out
+// uninitialised storage aligned to a cache line; an ArenaScope gives it back
+// when the scope ends, but the arena keeps its chunks, so the next call (the
+// next window, the next refill) reuses them without touching the heap. Once
+// everything has been given back, any extra chunks are merged into one big
+// enough for all of them, so a repeated pattern settles into a single chunk.
+// release() frees it all. Only for trivially copyable T, nothing is
+// destructed. A named arena counts its chunks in MemAccount.
+class Arena {
+public:
+    const static size_t ALIGN = 64;
+
+    struct Mark {
+        size_t chunk;
+        size_t offset;
+    };
+
+    explicit Arena(const char* name = nullptr, size_t min_chunk = 1 << 16)
+        : name(name), min_chunk(min_chunk) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena() { release(); }
+
+    template<typename T>
+    T* alloc(size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "arena storage is never destructed");
+        static_assert(alignof(T) <= ALIGN, "arena alignment too small");
+        if(n == 0) return nullptr;
+        size_t bytes = (n * sizeof(T) + ALIGN - 1) / ALIGN * ALIGN;
+        if(chunks.empty() or offset + bytes > chunks[cur].size) {
+            size_t next = chunks.empty() ? 0 : cur + 1;
+            if(next == chunks.size() or chunks[next].size < bytes)
+                chunks.insert(chunks.begin() + next, new_chunk(bytes));
+            cur = next;
+            offset = 0;
+        }
+        void * p = chunks[cur].ptr + offset;
+        offset += bytes;
+        return static_cast<T*>(p);
+    }
+
+    Mark mark() const {
+        return {cur, offset};
+    }
+
+    void rewind(Mark m) {
+        cur = m.chunk;
+        offset = m.offset;
+        if(cur == 0 and offset == 0 and chunks.size() > 1) {
+            size_t total = capacity();
+            free_chunks();
+            chunks.push_back(new_chunk(total));
+        }
+    }
+
+    void release() {
+        free_chunks();
+        cur = offset = 0;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for(const Chunk& c : chunks)
+            total += c.size;
+        return total;
+    }
+
+private:
+    struct Chunk {
+        char * ptr;
+        size_t size;
+    };
+
+    const char* name;
+    size_t min_chunk;
+    std::vector<Chunk> chunks;
+    size_t cur = 0, offset = 0;
+
+    Chunk new_chunk(size_t bytes) {
+        size_t size = std::max(bytes, min_chunk);
+        char * p = static_cast<char*>(::operator new(size, std::align_val_t(ALIGN)));
+        if(name != nullptr)
+            MemAccount::get().add(name, size);
+        return {p, size};
+    }
+
+    void free_chunks() {
+        for(const Chunk& c : chunks) {
+            ::operator delete(c.ptr, std::align_val_t(ALIGN));
+            if(name != nullptr)
+                MemAccount::get().add(name, -(int64_t)c.size);
+        }
+        chunks.clear();
+    }
+};
+
+// Gives back everything allocated from the arena after it was constructed.
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena): arena(arena), m(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(m); }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena& arena;
+    Arena::Mark m;
+};
+
+}
+#endif// EMP_ARENA_H
@@ -0,0 +1,78 @@
+#ifndef EMP_BUCKETING_H
+#define EMP_BUCKETING_H
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace emp {
+
+// Bucketing of leaky AND triples (WRK17, Section 4 / Theorem 3): `batch_size`
+// triples are made from batch_size*bucket_size leaky ones that are randomly
+// permuted into buckets. The adversary wins only if some bucket consists
+// solely of bad triples.
+struct BucketPlan {
+    int batch_size;  // triples to produce; >= the number asked for
+    int bucket_size;
+    int min_batch;   // smallest batch that is still secure at this bucket size
+};
+
+inline double log2_binomial(double n, double k) {
+    return (std::lgamma(n+1) - std::lgamma(k+1) - std::lgamma(n-k+1)) / std::log(2.0);
+}
+
+// Statistical security (in bits) of bucketing n triples with bucket size B.
+// With t bad leaky triples the failure probability is at most
+// 2^-t * n * C(t, B) / C(nB, B); the bound peaks for t in [B, 2B].
+inline double bucketing_security(int64_t n, int B) {
+    double worst = -1e300;
+    for(int64_t t = B; t <= std::min<int64_t>(2*B, n*B); ++t) {
+        double p = -(double)t + std::log2((double)n) + log2_binomial(t, B) - log2_binomial((double)n*B, B);
+        worst = std::max(worst, p);
+    }
+    return -worst;
+}
+
+// Smallest n for which bucket size B reaches ssp bits, or -1 if none below limit.
+inline int64_t bucketing_min_batch(int B, int ssp, int64_t limit) {
+    if(bucketing_security(limit, B) < ssp) return -1;
+    int64_t lo = 1, hi = limit;
+    while(lo < hi) {
+        int64_t mid = lo + (hi - lo)/2;
+        if(bucketing_security(mid, B) >= ssp) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+// Picks the bucket size that needs the fewest leaky triples for `size` AND
+// triples at `ssp` bits. Padding the batch up to the point where a smaller
+// bucket becomes secure is allowed: e.g. at ssp = 40, 2500 triples are
+// cheaper as a padded batch of 3044 in buckets of 4 than as 2500 in
+// buckets of 5. Batch sizes are kept even.
+inline BucketPlan plan_bucketing(int64_t size, int ssp = 40, int max_bucket_size = 16) {
+    size = std::max<int64_t>(size, 2);
+    size = ((size+1)/2)*2;
+    BucketPlan best = {0, 0, 0};
+    int64_t best_cost = INT64_MAX;
+    for(int B = 2; B <= max_bucket_size; ++B) {
+        int64_t limit = INT_MAX / (3*B);
+        if(size > limit) continue;
+        int64_t min_batch = bucketing_min_batch(B, ssp, limit);
+        if(min_batch < 0) continue;
+        int64_t batch = std::max(size, ((min_batch+1)/2)*2);
+        int64_t cost = batch * B;
+        if(cost < best_cost) {
+            best_cost = cost;
+            best = {(int)batch, B, (int)min_batch};
+        }
+    }
+    if(best.bucket_size == 0)
+        throw std::runtime_error("no bucket size reaches the requested statistical security");
+    return best;
+}
+
+}
+#endif// EMP_BUCKETING_H
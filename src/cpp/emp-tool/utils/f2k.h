@@ -17,12 +17,13 @@ inline void mul128(const block &a, const block &b, block *res1, block *res2) {
 
     // Perform carry-less multiplication (XOR-based) for GF(2^128)
     // Since standard C++ doesn't have carry-less multiplication, we'll implement it manually
+    // (nothing carries out of bit 0, and shifting by 64 is undefined)
 
     // Multiply a0 and b0
     for (int i = 0; i < 64; ++i) {
         if ((a0 >> i) & 1) {
             r0 ^= b0 << i;
-            r1 ^= b0 >> (64 - i);
+            if (i > 0) r1 ^= b0 >> (64 - i);
         }
     }
 
@@ -30,7 +31,7 @@ inline void mul128(const block &a, const block &b, block *res1, block *res2) {
     for (int i = 0; i < 64; ++i) {
         if ((a1 >> i) & 1) {
             r1 ^= b0 << i;
-            r2 ^= b0 >> (64 - i);
+            if (i > 0) r2 ^= b0 >> (64 - i);
         }
     }
 
@@ -38,7 +39,7 @@ inline void mul128(const block &a, const block &b, block *res1, block *res2) {
     for (int i = 0; i < 64; ++i) {
         if ((a0 >> i) & 1) {
             r1 ^= b1 << i;
-            r2 ^= b1 >> (64 - i);
+            if (i > 0) r2 ^= b1 >> (64 - i);
         }
     }
 
@@ -46,7 +47,7 @@ inline void mul128(const block &a, const block &b, block *res1, block *res2) {
     for (int i = 0; i < 64; ++i) {
         if ((a1 >> i) & 1) {
             r2 ^= b1 << i;
-            r3 ^= b1 >> (64 - i);
+            if (i > 0) r3 ^= b1 >> (64 - i);
         }
     }
 
@@ -0,0 +1,134 @@
+#ifndef EMP_MEM_ACCOUNT_H
+#define EMP_MEM_ACCOUNT_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace emp {
+
+// Live and peak bytes of the protocol's big buffers, by name, for sizing
+// worker memory limits. Only buffers tagged with a MemTag are counted, so the
+// totals are a lower bound on the heap; small and short-lived allocations are
+// left out. Peaks are since the last reset(), and the phase peak since the
+// last begin_phase(). Names must be string literals, they are kept as
+// pointers and not escaped.
+class MemAccount {
+public:
+    struct Entry {
+        const char* name;
+        int64_t live;
+        int64_t peak;
+    };
+
+    static MemAccount& get() {
+        static MemAccount account;
+        return account;
+    }
+
+    // bytes is negative for a release
+    void add(const char* name, int64_t bytes) {
+        if (bytes == 0)
+            return;
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& e = entry(name);
+        e.live += bytes;
+        e.peak = std::max(e.peak, e.live);
+        live_ += bytes;
+        peak_ = std::max(peak_, live_);
+        phase_peak_ = std::max(phase_peak_, live_);
+    }
+
+    int64_t live() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return live_;
+    }
+
+    int64_t peak() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return peak_;
+    }
+
+    int64_t phase_peak() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return phase_peak_;
+    }
+
+    std::vector<Entry> entries() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return table;
+    }
+
+    // Peaks start again from what is live now.
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Entry& e : table)
+            e.peak = e.live;
+        peak_ = phase_peak_ = live_;
+    }
+
+    void begin_phase() {
+        std::lock_guard<std::mutex> lock(mutex);
+        phase_peak_ = live_;
+    }
+
+    // {"live": .., "peak": .., "phasePeak": .., "buffers": [{"name": .., "live": .., "peak": ..}]}
+    std::string to_json() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::stringstream ss;
+        ss << "{\"live\": " << live_ << ", \"peak\": " << peak_
+           << ", \"phasePeak\": " << phase_peak_ << ", \"buffers\": [";
+        for (size_t i = 0; i < table.size(); ++i) {
+            const Entry& e = table[i];
+            ss << (i ? ", " : "") << "{\"name\": \"" << e.name << "\", \"live\": " << e.live
+               << ", \"peak\": " << e.peak << "}";
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<Entry> table;
+    int64_t live_ = 0, peak_ = 0, phase_peak_ = 0;
+
+    Entry& entry(const char* name) {
+        for (Entry& e : table)
+            if (e.name == name or strcmp(e.name, name) == 0)
+                return e;
+        table.push_back({name, 0, 0});
+        return table.back();
+    }
+};
+
+// Attributes bytes to a name in MemAccount for as long as it lives; set() it
+// whenever the buffer it stands for is (re)allocated or freed.
+class MemTag {
+public:
+    explicit MemTag(const char* name, int64_t bytes = 0): name(name) {
+        set(bytes);
+    }
+
+    ~MemTag() {
+        set(0);
+    }
+
+    void set(int64_t bytes) {
+        MemAccount::get().add(name, bytes - this->bytes);
+        this->bytes = bytes;
+    }
+
+    MemTag(const MemTag&) = delete;
+    MemTag& operator=(const MemTag&) = delete;
+
+private:
+    const char* name;
+    int64_t bytes = 0;
+};
+
+}
+#endif// EMP_MEM_ACCOUNT_H
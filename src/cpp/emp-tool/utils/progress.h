@@ -0,0 +1,65 @@
+#ifndef EMP_PROGRESS_H
+#define EMP_PROGRESS_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+namespace emp {
+
+// How far the current phase has got, for progress bars. The protocol code
+// reports `done` out of `total` units (gates, or ANDs while preprocessing) as
+// it goes; the handler is called at most once per interval, except that the
+// start (done == 0) and end (done == total) of a phase always get through.
+// Repeats of the last update are dropped. Without a handler, reporting is a
+// single check.
+class Progress {
+public:
+    using Handler = std::function<void(const char* phase, int64_t done, int64_t total)>;
+
+    static Progress& get() {
+        static Progress progress;
+        return progress;
+    }
+
+    void set_handler(Handler handler, int64_t interval_ms = 250) {
+        this->handler = handler;
+        this->interval_ms = interval_ms;
+        last_ms = -interval_ms;
+        last_phase = nullptr;
+    }
+
+    void update(const char* phase, int64_t done, int64_t total) {
+        if (!handler or (last_phase and strcmp(phase, last_phase) == 0 and done == last_done))
+            return;
+        int64_t now = now_ms();
+        if (done != 0 and done != total and now - last_ms < interval_ms)
+            return;
+        last_ms = now;
+        last_phase = phase;
+        last_done = done;
+        handler(phase, done, total);
+    }
+
+private:
+    Handler handler;
+    int64_t interval_ms = 250;
+    int64_t last_ms = 0;
+    const char* last_phase = nullptr;
+    int64_t last_done = 0;
+
+    static int64_t now_ms() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// For loops over gates: only looks at the clock every 1024 units.
+inline void report_progress(const char* phase, int64_t done, int64_t total) {
+    if (done % 1024 == 0 or done == total)
+        Progress::get().update(phase, done, total);
+}
+
+}
+#endif// EMP_PROGRESS_H
@@ -0,0 +1,113 @@
+#ifndef EMP_SPILL_BUFFER_H
+#define EMP_SPILL_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <stdexcept>
+#ifndef __EMSCRIPTEN__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "emp-tool/utils/mem_account.h"
+
+namespace emp {
+
+// Flat array of trivially copyable T that is either on the heap or, on native
+// builds, in a shared mapping of an unlinked temporary file. Spilled pages are
+// file backed, so the kernel can write them out and drop them under memory
+// pressure instead of the process running out of RAM; nothing is left on disk
+// once the buffer is released or the process exits. The file goes in $TMPDIR
+// (default /tmp). The Wasm build has no such backing and always uses the heap.
+// Heap storage is aligned to a cache line, mapped storage to a page. A named
+// buffer counts its heap storage in MemAccount; spilled storage is not
+// counted, since the kernel can drop it.
+template<typename T>
+class SpillBuffer {
+public:
+    const static size_t ALIGN = 64;
+
+    explicit SpillBuffer(const char* name = nullptr): name(name) {}
+    SpillBuffer(const SpillBuffer&) = delete;
+    SpillBuffer& operator=(const SpillBuffer&) = delete;
+    ~SpillBuffer() { release(); }
+
+    // Allocates n zeroed elements; spills to a file if their size exceeds
+    // spill_threshold bytes. A negative threshold never spills.
+    void alloc(size_t n, int64_t spill_threshold = -1) {
+        release();
+        size_ = n;
+        if(n == 0) return;
+#ifndef __EMSCRIPTEN__
+        if(spill_threshold >= 0 and (int64_t)bytes() > spill_threshold) {
+            map_file();
+            return;
+        }
+#endif
+        ptr = static_cast<T*>(::operator new(bytes(), std::align_val_t(ALIGN)));
+        memset(ptr, 0, bytes());
+        if(name != nullptr)
+            MemAccount::get().add(name, bytes());
+    }
+
+    void release() {
+#ifndef __EMSCRIPTEN__
+        if(mapped) {
+            munmap(ptr, bytes());
+            mapped = false;
+            ptr = nullptr;
+        }
+#endif
+        if(ptr != nullptr) {
+            ::operator delete(ptr, std::align_val_t(ALIGN));
+            if(name != nullptr)
+                MemAccount::get().add(name, -(int64_t)bytes());
+        }
+        ptr = nullptr;
+        size_ = 0;
+    }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    size_t size() const { return size_; }
+    size_t bytes() const { return size_ * sizeof(T); }
+    bool spilled() const { return mapped; }
+
+private:
+    const char* name;
+    T* ptr = nullptr;
+    size_t size_ = 0;
+    bool mapped = false;
+
+#ifndef __EMSCRIPTEN__
+    void map_file() {
+        const char * dir = getenv("TMPDIR");
+        std::string path = std::string(dir != nullptr and dir[0] != '\0' ? dir : "/tmp") + "/emp-spill-XXXXXX";
+        int fd = mkstemp(&path[0]);
+        if(fd < 0)
+            throw std::runtime_error("spill buffer: cannot create " + path);
+        unlink(path.c_str());
+        if(ftruncate(fd, bytes()) != 0) {
+            close(fd);
+            throw std::runtime_error("spill buffer: cannot grow " + path);
+        }
+        void * p = mmap(nullptr, bytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if(p == MAP_FAILED)
+            throw std::runtime_error("spill buffer: cannot map " + path);
+        // tables are written and read in gate order
+        madvise(p, bytes(), MADV_SEQUENTIAL);
+        ptr = static_cast<T*>(p);
+        mapped = true;
+    }
+#endif
+};
+
+}
+#endif// EMP_SPILL_BUFFER_H
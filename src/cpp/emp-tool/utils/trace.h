@@ -0,0 +1,138 @@
+#ifndef EMP_TRACE_H
+#define EMP_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace emp {
+
+// Collects timed spans for viewing as a flame graph in chrome://tracing or
+// Perfetto. Tracing is off until enable() is called; until then a
+// TRACE_SCOPE costs one relaxed load. Building with EMP_NO_TRACE removes even
+// that. Span names must be string literals, they are kept as
+// pointers and not escaped.
+class Tracer {
+public:
+    struct Event {
+        const char* name;
+        int64_t start_us;
+        int64_t dur_us;
+        uint32_t tid;
+    };
+
+    static Tracer& get() {
+        static Tracer tracer;
+        return tracer;
+    }
+
+    bool enabled() const {
+        return on.load(std::memory_order_relaxed);
+    }
+
+    // pid labels the events, so traces of several parties can be merged
+    void enable(int pid = 0) {
+        this->pid = pid;
+        on.store(true, std::memory_order_relaxed);
+    }
+
+    void disable() {
+        on.store(false, std::memory_order_relaxed);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.clear();
+    }
+
+    // steady clock, which all processes on a machine share, so merged
+    // traces line up
+    static int64_t now_us() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void record(const char* name, int64_t start_us, int64_t end_us) {
+        static std::atomic<uint32_t> next_tid{1};
+        thread_local uint32_t tid = next_tid++;
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back({name, start_us, end_us - start_us, tid});
+    }
+
+    // The events as comma separated trace_event objects, to splice into the
+    // traceEvents array of a merged trace.
+    std::string events_json() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::stringstream ss;
+        for (size_t i = 0; i < events.size(); ++i) {
+            const Event& e = events[i];
+            ss << (i ? ",\n" : "") << "{\"name\": \"" << e.name << "\", \"ph\": \"X\""
+               << ", \"ts\": " << e.start_us << ", \"dur\": " << e.dur_us
+               << ", \"pid\": " << pid << ", \"tid\": " << e.tid << "}";
+        }
+        return ss.str();
+    }
+
+    // Chrome trace_event JSON
+    std::string to_json() {
+        return "{\"traceEvents\": [\n" + events_json() + "\n], \"displayTimeUnit\": \"ms\"}\n";
+    }
+
+    void write_json(const std::string& path) {
+        std::ofstream f(path);
+        f << to_json();
+        if (!f.good())
+            throw std::runtime_error("Cannot write trace to " + path);
+    }
+
+private:
+    std::atomic<bool> on{false};
+    int pid = 0;
+    std::mutex mutex;
+    std::vector<Event> events;
+};
+
+// Records the time from construction to destruction, or to end(), if tracing
+// is enabled.
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name): name(name) {
+#ifndef EMP_NO_TRACE
+        if (Tracer::get().enabled())
+            start_us = Tracer::now_us();
+#endif
+    }
+
+    ~TraceSpan() {
+        end();
+    }
+
+    void end() {
+        if (start_us >= 0)
+            Tracer::get().record(name, start_us, Tracer::now_us());
+        start_us = -1;
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    int64_t start_us = -1;
+};
+
+}
+
+#define EMP_TRACE_CAT2(a, b) a##b
+#define EMP_TRACE_CAT(a, b) EMP_TRACE_CAT2(a, b)
+
+// Traces the rest of the enclosing scope.
+#define TRACE_SCOPE(name) emp::TraceSpan EMP_TRACE_CAT(emp_trace_span_, __LINE__)(name)
+
+#endif// EMP_TRACE_H
@@ -0,0 +1,111 @@
+import { IO } from "./types";
+
+export type LinkOptions = {
+  /** One way delay in ms. */
+  latency?: number,
+  /** Bytes per second on each link (one party, one channel, one direction), 0 for unlimited. */
+  bandwidth?: number,
+  /** Extra delay in ms, uniform in [0, jitter], drawn from `seed`. */
+  jitter?: number,
+  seed?: number,
+};
+
+/**
+ * Wraps an IO so that everything sent through it arrives as if over a slower
+ * network: after the link has spent len / bandwidth seconds sending it
+ * (behind anything sent earlier), plus the latency and jitter. Data stays in
+ * order on each link. Wrapping each party's IO gives every direction its own
+ * delay, so a round trip costs twice the latency, as it would over a real
+ * network. The jitter only depends on the seed and the order of sends.
+ */
+export default class SimulatedLinkIO implements IO {
+  private latency: number;
+  private bandwidth: number;
+  private jitter: number;
+  private rng: () => number;
+  private links = new Map<string, {
+    busyUntil: number,
+    lastArrival: number,
+    pending: { at: number, data: Uint8Array }[],
+  }>();
+
+  constructor(private inner: IO, options: LinkOptions = {}) {
+    this.latency = options.latency ?? 0;
+    this.bandwidth = options.bandwidth ?? 0;
+    this.jitter = options.jitter ?? 0;
+    this.rng = mulberry32(options.seed ?? 1);
+  }
+
+  send(toParty: number, channel: 'a' | 'b', data: Uint8Array) {
+    if (this.latency === 0 && this.bandwidth === 0 && this.jitter === 0) {
+      this.inner.send(toParty, channel, data);
+      return;
+    }
+
+    const key = `${toParty}:${channel}`;
+    let link = this.links.get(key);
+
+    if (link === undefined) {
+      link = { busyUntil: 0, lastArrival: 0, pending: [] };
+      this.links.set(key, link);
+    }
+
+    const now = performance.now();
+    const sendMs = this.bandwidth === 0 ? 0 : 1000 * data.length / this.bandwidth;
+    link.busyUntil = Math.max(now, link.busyUntil) + sendMs;
+
+    // jitter must not reorder the link
+    const at = Math.max(link.busyUntil + this.latency + this.jitter * this.rng(), link.lastArrival);
+    link.lastArrival = at;
+    link.pending.push({ at, data });
+
+    if (link.pending.length === 1) {
+      this.deliverLater(toParty, channel, link.pending);
+    }
+  }
+
+  recv(fromParty: number, channel: 'a' | 'b', min_len: number, max_len: number) {
+    return this.inner.recv(fromParty, channel, min_len, max_len);
+  }
+
+  on(event: 'error', listener: (error: Error) => void) {
+    this.inner.on?.(event, listener);
+  }
+
+  off(event: 'error', listener: (error: Error) => void) {
+    this.inner.off?.(event, listener);
+  }
+
+  close() {
+    this.inner.close?.();
+  }
+
+  // delivers in order from one timer per link, since timers with different
+  // delays are not guaranteed to fire in the order of their due times
+  private deliverLater(toParty: number, channel: 'a' | 'b', pending: { at: number, data: Uint8Array }[]) {
+    setTimeout(() => {
+      const now = performance.now();
+
+      while (pending.length > 0 && pending[0].at <= now) {
+        this.inner.send(toParty, channel, pending.shift()!.data);
+      }
+
+      if (pending.length > 0) {
+        this.deliverLater(toParty, channel, pending);
+      }
+    }, Math.max(0, pending[0].at - performance.now()));
+  }
+}
+
+// small seeded PRNG, uniform in [0, 1)
+function mulberry32(seed: number) {
+  let a = seed >>> 0;
+
+  return () => {
+    a = (a + 0x6d2b79f5) >>> 0;
+    let t = a;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
@@ -1,10 +1,17 @@
-import type { IO } from "./types";
+import type { IO, MemoryReport, MPCProgress } from "./types";
 
 type Module = {
   emp?: {
     circuitBinary?: Uint8Array;
     inputBits?: Uint8Array;
     inputBitsPerParty?: number[];
+    statisticalSecurity?: number;
+    evaluator?: number;
+    outputBitsPerParty?: number[];
+    onPhase?: (phase: string, heapBytes: number) => void;
+    onTrace?: (traceJson: string) => void;
+    onProgress?: (progress: MPCProgress) => void;
+    onMemory?: (report: MemoryReport) => void;
     io?: IO;
     handleOutput?: (value: Uint8Array) => void;
   };
@@ -26,10 +33,38 @@ declare const createModule: () => Promise<Module>
  * @param inputBits - The input bits for the circuit, represented as one bit per byte.
  * @param inputBitsPerParty - The number of input bits for each party.
  * @param io - Input/output channels for communication between the two parties.
+ * @param statisticalSecurity - Statistical security parameter in bits (default
+ *   40, also the maximum). All parties must use the same value. It selects
+ *   the bucket size for AND triple generation and, in mpc mode, the size of
+ *   the abit checks. Values above 40 are rejected, since the garbled-row and
+ *   output MAC checks are truncated and would not reach them.
+ * @param evaluator - The party index that evaluates the garbled circuit in mpc
+ *   mode (default 0). All parties must use the same value. It receives the
+ *   garbled tables from every other party, so rotating it between runs
+ *   spreads that traffic.
+ * @param outputBitsPerParty - If given, the number of output bits that go to
+ *   each party: party 0 gets the first outputBitsPerParty[0] output bits, and
+ *   so on. Each party then only learns (and gets back) its own bits, and no
+ *   bandwidth is spent opening the others. By default every party gets every
+ *   output bit. All parties must use the same value.
+ * @param onPhase - Called as each phase finishes (setup,
+ *   function_independent, function_dependent, online), with the size of the
+ *   Wasm heap at that point in bytes.
+ * @param onTrace - If given, tracing is switched on and this is called at the
+ *   end with the run's spans (see trace.h) as Chrome trace_event JSON, for
+ *   chrome://tracing or https://ui.perfetto.dev.
+ * @param onProgress - Called with how far the run has got (phase, gates
+ *   done, bytes sent and received), at most four times a second and at the
+ *   start and end of each phase.
+ * @param onMemory - Called as each phase finishes with the live and peak
+ *   bytes of the protocol's big buffers, by name (see mem_account.h), and
+ *   the peak within that phase.
  * @returns A promise resolving with the output bits of the circuit.
  */
 async function secureMPC({
   party, size, circuitBinary, inputBits, inputBitsPerParty, io, mode = 'auto',
+  statisticalSecurity = 40, evaluator = 0, outputBitsPerParty, onPhase,
+  onTrace, onProgress, onMemory,
 }: {
   party: number,
   size: number,
@@ -38,6 +73,13 @@ async function secureMPC({
   inputBitsPerParty: number[],
   io: IO,
   mode?: '2pc' | 'mpc' | 'auto',
+  statisticalSecurity?: number,
+  evaluator?: number,
+  outputBitsPerParty?: number[],
+  onPhase?: (phase: string, heapBytes: number) => void,
+  onTrace?: (traceJson: string) => void,
+  onProgress?: (progress: MPCProgress) => void,
+  onMemory?: (report: MemoryReport) => void,
 }): Promise<Uint8Array> {
   const module = await createModule();
 
@@ -51,6 +93,13 @@ async function secureMPC({
     circuitBinary?: Uint8Array;
     inputBits?: Uint8Array;
     inputBitsPerParty?: number[];
+    statisticalSecurity?: number;
+    evaluator?: number;
+    outputBitsPerParty?: number[];
+    onPhase?: (phase: string, heapBytes: number) => void;
+    onTrace?: (traceJson: string) => void;
+    onProgress?: (progress: MPCProgress) => void;
+    onMemory?: (report: MemoryReport) => void;
     io?: IO;
     handleOutput?: (value: Uint8Array) => void
     handleError?: (error: Error) => void;
@@ -61,6 +110,13 @@ async function secureMPC({
   emp.circuitBinary = circuitBinary;
   emp.inputBits = inputBits;
   emp.inputBitsPerParty = inputBitsPerParty;
+  emp.statisticalSecurity = statisticalSecurity;
+  emp.evaluator = evaluator;
+  emp.outputBitsPerParty = outputBitsPerParty;
+  emp.onPhase = onPhase;
+  emp.onTrace = onTrace;
+  emp.onProgress = onProgress;
+  emp.onMemory = onMemory;
 
   let reject: undefined | ((error: unknown) => void) = undefined;
   const callbackRejector = new Promise((_resolve, rej) => {
@@ -133,7 +189,10 @@ onmessage = async (event) => {
   const message = event.data;
 
   if (message.type === 'start') {
-    const { party, size, circuitBinary, inputBits, inputBitsPerParty, mode } = message;
+    const {
+      party, size, circuitBinary, inputBits, inputBitsPerParty, mode, statisticalSecurity,
+      evaluator, outputBitsPerParty, trace, progress, memory,
+    } = message;
 
     // Create a proxy IO object to communicate with the main thread
     const io: IO = {
@@ -158,6 +217,21 @@ onmessage = async (event) => {
         inputBitsPerParty,
         io,
         mode,
+        statisticalSecurity,
+        evaluator,
+        outputBitsPerParty,
+        onPhase: (phase, heapBytes) => {
+          postMessage({ type: 'phase', phase, heapBytes });
+        },
+        onTrace: trace
+          ? traceJson => postMessage({ type: 'trace', traceJson })
+          : undefined,
+        onProgress: progress
+          ? p => postMessage({ type: 'progress', progress: p })
+          : undefined,
+        onMemory: memory
+          ? report => postMessage({ type: 'memory', report })
+          : undefined,
       });
 
       postMessage({ type: 'result', result });
@@ -0,0 +1,140 @@
+/**
+ * Places `count` independent copies of a circuit (in the binary layout of
+ * `bristolToBinary`) side by side in one circuit, so that a single secureMPC
+ * session evaluates them all and pays for setup and preprocessing checks once.
+ *
+ * Wire layout of the result:
+ * - inputs: each party's input bits stay contiguous, copy 0 first, i.e.
+ *   party p provides its inputs for copy 0, then copy 1, and so on
+ * - outputs: the last `count * n3` wires, laid out like the inputs: each
+ *   group of `outputBitsPerParty` stays contiguous, copy 0 first. Without
+ *   groups, this is one block of n3 bits per copy.
+ * - everything else in between, one block per copy
+ *
+ * Gates are emitted copy by copy, so each copy stays in topological order.
+ */
+export default function batchCircuit(
+  circuitBinary: Uint8Array,
+  inputBitsPerParty: number[],
+  count: number,
+  outputBitsPerParty?: number[],
+): Uint8Array {
+  if (!Number.isInteger(count) || count < 1) {
+    throw new Error('Batch count must be a positive integer');
+  }
+
+  if (circuitBinary.byteLength < 20) {
+    throw new Error('Buffer shorter than 20-byte header');
+  }
+
+  const view = new DataView(
+    circuitBinary.buffer,
+    circuitBinary.byteOffset,
+    circuitBinary.byteLength,
+  );
+
+  const [numGate, numWire, n1, n2, n3] = [0, 1, 2, 3, 4].map(
+    i => view.getUint32(4 * i, true),
+  );
+
+  const numIn = n1 + n2;
+  const numInternal = numWire - numIn - n3;
+
+  if (numInternal < 0) {
+    throw new Error('Circuit inputs and outputs overlap');
+  }
+
+  if (inputBitsPerParty.reduce((a, b) => a + b, 0) !== numIn) {
+    throw new Error('Mismatch between circuit and inputBitsPerParty');
+  }
+
+  const outputGroups = outputBitsPerParty ?? [n3];
+
+  if (outputGroups.reduce((a, b) => a + b, 0) !== n3) {
+    throw new Error('Mismatch between circuit and outputBitsPerParty');
+  }
+
+  const inputMap = groupMap(inputBitsPerParty, count);
+  const outputMap = groupMap(outputGroups, count);
+
+  const outputStart = numWire - n3;
+  const batchedWires = count * numWire;
+
+  const mapWire = (w: number, k: number) => {
+    if (w >= numWire) {
+      throw new Error(`Wire ${w} out of range`);
+    }
+
+    if (w < numIn) {
+      return inputMap[k * numIn + w];
+    }
+
+    if (w >= outputStart) {
+      return batchedWires - count * n3 + outputMap[k * n3 + w - outputStart];
+    }
+
+    return count * numIn + k * numInternal + (w - numIn);
+  };
+
+  const gatesLength = circuitBinary.byteLength - 20;
+  const out = new Uint8Array(20 + count * gatesLength);
+  const outView = new DataView(out.buffer);
+
+  [count * numGate, batchedWires, count * n1, count * n2, count * n3].forEach(
+    (v, i) => outView.setUint32(4 * i, v, true),
+  );
+
+  let off = 20;
+
+  for (let k = 0; k < count; k++) {
+    let inOff = 20;
+
+    while (inOff < circuitBinary.byteLength) {
+      const code = view.getUint8(inOff);
+      const wireCount = code === 0 ? 2 : 3;
+
+      if (code > 2) {
+        throw new Error(`Unknown gate code ${code} at byte ${inOff}`);
+      }
+
+      if (inOff + 1 + 4 * wireCount > circuitBinary.byteLength) {
+        throw new Error('Truncated wire index');
+      }
+
+      outView.setUint8(off, code);
+
+      for (let j = 0; j < wireCount; j++) {
+        const w = view.getUint32(inOff + 1 + 4 * j, true);
+        outView.setUint32(off + 1 + 4 * j, mapWire(w, k), true);
+      }
+
+      inOff += 1 + 4 * wireCount;
+      off += 1 + 4 * wireCount;
+    }
+  }
+
+  return out;
+}
+
+/**
+ * For `count` copies of bits split into consecutive groups, maps bit i of
+ * copy k (index `k * total + i`) to its position when each group keeps the
+ * bits of all copies together, copy 0 first.
+ */
+function groupMap(groups: number[], count: number): Uint32Array {
+  const total = groups.reduce((a, b) => a + b, 0);
+  const map = new Uint32Array(total * count);
+  let start = 0;
+
+  for (const bits of groups) {
+    for (let k = 0; k < count; k++) {
+      for (let i = 0; i < bits; i++) {
+        map[k * total + start + i] = count * start + k * bits + i;
+      }
+    }
+
+    start += bits;
+  }
+
+  return map;
+}
@@ -11,6 +11,11 @@
  *  │            │   XOR/AND: 3 × uint32 (in1,in2,out)         │
  *  └────────────┴─────────────────────────────────────────────┘
  *
+ *  The header may also be in Bristol Fashion, i.e. input and output wire
+ *  group sizes on lines 2 and 3. Two input groups become n1 and n2, any
+ *  other number is summed into n1, and the output groups are summed into
+ *  n3 (pass outputBitsPerParty to secureMPC to route them to parties).
+ *
  *  Any deviation from the expected syntax throws an Error.
  */
 export default function bristolToBinary(source: string): Uint8Array {
@@ -28,15 +33,37 @@ export default function bristolToBinary(source: string): Uint8Array {
   const h1 = rawLines[0].trim().split(/\s+/);
   const h2 = rawLines[1].trim().split(/\s+/);
   if (h1.length !== 2) throw new Error("Header line 1: expected exactly 2 numbers");
-  if (h2.length !== 3) throw new Error("Header line 2: expected exactly 3 numbers");
-  const header = [...h1, ...h2].map((t, i) => toInt(t, `header[${i}]`));
+
+  // a gate line always ends in its type, so a line 3 of only numbers is
+  // Bristol Fashion's output groups
+  const h3Line = rawLines[2].trim();
+  const fashion = h3Line !== "" && /^\d+(\s+\d+)*$/.test(h3Line);
+  let header: number[];
+
+  if (fashion) {
+    const groups = (tokens: string[], ln: number) => {
+      const sizes = tokens.map((t, i) => toInt(t, `line ${ln} [${i}]`));
+      if (sizes[0] !== sizes.length - 1) {
+        throw new Error(`Header line ${ln}: expected ${sizes[0]} group sizes`);
+      }
+      return sizes.slice(1);
+    };
+    const inputs = groups(h2, 2);
+    const outputs = groups(h3Line.split(/\s+/), 3);
+    const sum = (xs: number[]) => xs.reduce((a, b) => a + b, 0);
+    const [n1, n2] = inputs.length === 2 ? inputs : [sum(inputs), 0];
+    header = [...h1.map((t, i) => toInt(t, `header[${i}]`)), n1, n2, sum(outputs)];
+  } else {
+    if (h2.length !== 3) throw new Error("Header line 2: expected exactly 3 numbers");
+    header = [...h1, ...h2].map((t, i) => toInt(t, `header[${i}]`));
+  }
 
   /* ---------- gate parsing ---------- */
   const GATE_CODE = { INV: 0, XOR: 1, AND: 2 } as const;
   type Gate = { code: number; wires: number[] };
 
   const gates: Gate[] = [];
-  for (let ln = 2; ln < rawLines.length; ln++) {
+  for (let ln = fashion ? 3 : 2; ln < rawLines.length; ln++) {
     const line = rawLines[ln].trim();
     if (line === "") continue; // allow a single blank separator – still not “ignored”
     const parts = line.split(/\s+/);
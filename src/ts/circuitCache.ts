@@ -0,0 +1,175 @@
+import bristolToBinary from "./bristolToBinary.js";
+import optimizeCircuit from "./optimizeCircuit.js";
+
+/**
+ * Somewhere to keep circuit binaries between sessions, keyed by the hash
+ * of the circuit they were made from.
+ */
+export type CircuitStore = {
+  get(key: string): Promise<Uint8Array | undefined>;
+  set(key: string, value: Uint8Array): Promise<void>;
+};
+
+/**
+ * Content-addressed cache of circuit binaries, so that running the same
+ * circuit again skips parsing the Bristol text (and optimizing it, with
+ * `optimize: true`). Entries are keyed by the SHA-256 of the circuit, so
+ * equal circuits hit the cache even when they come from different strings.
+ *
+ * Binaries are kept in memory, least recently used first out once they add
+ * up to more than `maxBytes`. With a `store` (see nodeDiskStore and
+ * indexedDBStore) they are also persisted and survive a reload.
+ */
+export class CircuitCache {
+  maxBytes: number;
+  store?: CircuitStore;
+
+  private entries = new Map<string, Uint8Array>();
+  private bytes = 0;
+
+  constructor({ maxBytes = 256 * 1024 * 1024, store }: {
+    maxBytes?: number,
+    store?: CircuitStore,
+  } = {}) {
+    this.maxBytes = maxBytes;
+    this.store = store;
+  }
+
+  /**
+   * The binary for `circuit` (a Uint8Array is taken to be a binary already),
+   * optionally optimized.
+   */
+  async getBinary(
+    circuit: string | Uint8Array,
+    { optimize = false }: { optimize?: boolean } = {},
+  ): Promise<Uint8Array> {
+    if (typeof circuit !== 'string' && !optimize) {
+      return circuit;
+    }
+
+    const key = `${await circuitHash(circuit)}${optimize ? '-opt' : ''}`;
+    let binary = this.entries.get(key);
+
+    if (binary !== undefined) {
+      // move to the back, so the least recently used one is evicted first
+      this.entries.delete(key);
+      this.entries.set(key, binary);
+
+      return binary;
+    }
+
+    binary = await this.store?.get(key);
+
+    if (binary === undefined) {
+      binary = typeof circuit === 'string' ? bristolToBinary(circuit) : circuit;
+
+      if (optimize) {
+        binary = optimizeCircuit(binary).circuit;
+      }
+
+      await this.store?.set(key, binary);
+    }
+
+    this.add(key, binary);
+
+    return binary;
+  }
+
+  clear() {
+    this.entries.clear();
+    this.bytes = 0;
+  }
+
+  private add(key: string, binary: Uint8Array) {
+    this.entries.set(key, binary);
+    this.bytes += binary.byteLength;
+
+    for (const [oldKey, old] of this.entries) {
+      if (this.bytes <= this.maxBytes || oldKey === key) {
+        break;
+      }
+
+      this.entries.delete(oldKey);
+      this.bytes -= old.byteLength;
+    }
+  }
+}
+
+/** Used by secureMPC unless it is given another cache. */
+export const defaultCircuitCache = new CircuitCache();
+
+async function circuitHash(circuit: string | Uint8Array): Promise<string> {
+  // text and binary forms of the same circuit get different keys
+  const [prefix, bytes] = typeof circuit === 'string'
+    ? ['t', new TextEncoder().encode(circuit)]
+    : ['b', circuit];
+
+  const digest = new Uint8Array(await crypto.subtle.digest('SHA-256', bytes));
+
+  return prefix + Array.from(digest, b => b.toString(16).padStart(2, '0')).join('');
+}
+
+/** Persists circuit binaries as files in `dir` (Node only). */
+export function nodeDiskStore(dir: string): CircuitStore {
+  // kept out of browser bundles
+  const fsModule = 'node:fs/promises';
+  const fs = () => import(/* @vite-ignore */ fsModule) as Promise<typeof import('fs/promises')>;
+  const file = (key: string) => `${dir}/${key}.bin`;
+
+  return {
+    async get(key) {
+      try {
+        return new Uint8Array(await (await fs()).readFile(file(key)));
+      } catch {
+        return undefined;
+      }
+    },
+
+    async set(key, value) {
+      const { mkdir, writeFile, rename } = await fs();
+      const tmp = `${file(key)}.${Math.random().toString(36).slice(2)}`;
+
+      // write then rename, so a concurrent reader never sees half a file
+      await mkdir(dir, { recursive: true });
+      await writeFile(tmp, value);
+      await rename(tmp, file(key));
+    },
+  };
+}
+
+/** Persists circuit binaries in an IndexedDB database (browsers). */
+export function indexedDBStore(dbName = 'emp-wasm-circuits'): CircuitStore {
+  const storeName = 'circuits';
+  let db: Promise<IDBDatabase> | undefined;
+
+  const open = () => {
+    db ??= new Promise((resolve, reject) => {
+      const req = indexedDB.open(dbName, 1);
+      req.onupgradeneeded = () => req.result.createObjectStore(storeName);
+      req.onsuccess = () => resolve(req.result);
+      req.onerror = () => reject(req.error);
+    });
+
+    return db;
+  };
+
+  const request = async <T>(
+    mode: IDBTransactionMode,
+    f: (store: IDBObjectStore) => IDBRequest,
+  ): Promise<T> => {
+    const store = (await open()).transaction(storeName, mode).objectStore(storeName);
+
+    return new Promise((resolve, reject) => {
+      const req = f(store);
+      req.onsuccess = () => resolve(req.result);
+      req.onerror = () => reject(req.error);
+    });
+  };
+
+  return {
+    get: key => request<Uint8Array | undefined>('readonly', s => s.get(key)),
+    set: async (key, value) => {
+      await request('readwrite', s => s.put(value, key));
+    },
+  };
+}
@@ -1,5 +1,12 @@
 export { default as secureMPC } from "./secureMPC.js";
+export { default as secureMPCBatch } from "./secureMPCBatch.js";
+export { default as bristolToBinary } from "./bristolToBinary.js";
+export { default as optimizeCircuit, type OptimizeReport } from "./optimizeCircuit.js";
+export {
+  CircuitCache, defaultCircuitCache, nodeDiskStore, indexedDBStore, type CircuitStore,
+} from "./circuitCache.js";
 export { default as BufferedIO } from "./BufferedIO.js";
 export { default as BufferQueue } from "./BufferQueue.js";
-export { type IO } from "./types";
+export { default as SimulatedLinkIO, type LinkOptions } from "./SimulatedLinkIO.js";
+export { type IO, type MemoryReport, type MPCProgress } from "./types";
 export { channelFromByte, byteFromChannel } from "./utils.js";
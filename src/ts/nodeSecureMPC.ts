@@ -1,4 +1,4 @@
-import type { IO } from "./types";
+import type { IO, MemoryReport, MPCProgress } from "./types";
 
 /**
  * Runs a secure multi-party computation (MPC) using a specified circuit.
@@ -9,10 +9,38 @@ import type { IO } from "./types";
  * @param inputBits - The input to the circuit, represented as one bit per byte.
  * @param inputBitsPerParty - The number of input bits for each party.
  * @param io - Input/output channels for communication between the two parties.
+ * @param statisticalSecurity - Statistical security parameter in bits (default
+ *   40, also the maximum). All parties must use the same value. It selects
+ *   the bucket size for AND triple generation and, in mpc mode, the size of
+ *   the abit checks. Values above 40 are rejected, since the garbled-row and
+ *   output MAC checks are truncated and would not reach them.
+ * @param evaluator - The party index that evaluates the garbled circuit in mpc
+ *   mode (default 0). All parties must use the same value. It receives the
+ *   garbled tables from every other party, so rotating it between runs
+ *   spreads that traffic.
+ * @param outputBitsPerParty - If given, the number of output bits that go to
+ *   each party: party 0 gets the first outputBitsPerParty[0] output bits, and
+ *   so on. Each party then only learns (and gets back) its own bits, and no
+ *   bandwidth is spent opening the others. By default every party gets every
+ *   output bit. All parties must use the same value.
+ * @param onPhase - Called as each phase finishes (setup,
+ *   function_independent, function_dependent, online), with the size of the
+ *   Wasm heap at that point in bytes.
+ * @param onTrace - If given, tracing is switched on and this is called at the
+ *   end with the run's spans (see trace.h) as Chrome trace_event JSON, for
+ *   chrome://tracing or https://ui.perfetto.dev.
+ * @param onProgress - Called with how far the run has got (phase, gates
+ *   done, bytes sent and received), at most four times a second and at the
+ *   start and end of each phase.
+ * @param onMemory - Called as each phase finishes with the live and peak
+ *   bytes of the protocol's big buffers, by name (see mem_account.h), and
+ *   the peak within that phase.
  * @returns A promise resolving with the output bits of the circuit.
  */
 export default async function nodeSecureMPC({
   party, size, circuitBinary, inputBits, inputBitsPerParty, io, mode = 'auto',
+  statisticalSecurity = 40, evaluator = 0, outputBitsPerParty, onPhase,
+  onTrace, onProgress, onMemory,
 }: {
   party: number,
   size: number,
@@ -21,6 +49,13 @@ export default async function nodeSecureMPC({
   inputBitsPerParty: number[],
   io: IO,
   mode?: '2pc' | 'mpc' | 'auto',
+  statisticalSecurity?: number,
+  evaluator?: number,
+  outputBitsPerParty?: number[],
+  onPhase?: (phase: string, heapBytes: number) => void,
+  onTrace?: (traceJson: string) => void,
+  onProgress?: (progress: MPCProgress) => void,
+  onMemory?: (report: MemoryReport) => void,
 }): Promise<Uint8Array> {
   if (typeof process === 'undefined' || typeof process.versions === 'undefined' || !process.versions.node) {
     throw new Error('Not running in Node.js');
@@ -32,6 +67,13 @@ export default async function nodeSecureMPC({
     circuitBinary?: Uint8Array;
     inputBits?: Uint8Array;
     inputBitsPerParty?: number[];
+    statisticalSecurity?: number;
+    evaluator?: number;
+    outputBitsPerParty?: number[];
+    onPhase?: (phase: string, heapBytes: number) => void;
+    onTrace?: (traceJson: string) => void;
+    onProgress?: (progress: MPCProgress) => void;
+    onMemory?: (report: MemoryReport) => void;
     io?: IO;
     handleOutput?: (value: Uint8Array) => void;
     handleError?: (error: Error) => void;
@@ -42,6 +84,13 @@ export default async function nodeSecureMPC({
   emp.circuitBinary = circuitBinary;
   emp.inputBits = inputBits;
   emp.inputBitsPerParty = inputBitsPerParty;
+  emp.statisticalSecurity = statisticalSecurity;
+  emp.evaluator = evaluator;
+  emp.outputBitsPerParty = outputBitsPerParty;
+  emp.onPhase = onPhase;
+  emp.onTrace = onTrace;
+  emp.onProgress = onProgress;
+  emp.onMemory = onMemory;
 
   let reject: undefined | ((error: unknown) => void) = undefined;
   const callbackRejector = new Promise((_resolve, rej) => {
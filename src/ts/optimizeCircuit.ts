@@ -0,0 +1,299 @@
+export type OptimizeReport = {
+  gatesBefore: number,
+  gatesAfter: number,
+  andsBefore: number,
+  andsAfter: number,
+};
+
+/**
+ * Simplifies a circuit (in the binary layout of `bristolToBinary`) without
+ * changing what it computes, so that less has to be garbled:
+ * - INV gates are absorbed into wires as a negation flag, and XOR gates pass
+ *   the flag through (free-XOR makes this exact)
+ * - constants are propagated: XOR(a, a), AND(a, a), AND(a, ¬a) and any
+ *   gate with a constant input are folded
+ * - XOR and AND gates with the same inputs (in either order) are merged
+ * - gates that no output depends on are dropped
+ *
+ * Inputs keep their positions and the outputs stay the last n3 wires, so the
+ * result is a drop-in replacement. Every AND removed saves an authenticated
+ * triple and a garbled table. INV gates cost nothing to garble, so moving
+ * negations around can leave a few more of them than before.
+ */
+export default function optimizeCircuit(
+  circuitBinary: Uint8Array,
+): { circuit: Uint8Array, report: OptimizeReport } {
+  if (circuitBinary.byteLength < 20) {
+    throw new Error('Buffer shorter than 20-byte header');
+  }
+
+  const view = new DataView(
+    circuitBinary.buffer,
+    circuitBinary.byteOffset,
+    circuitBinary.byteLength,
+  );
+
+  const [numGate, numWire, n1, n2, n3] = [0, 1, 2, 3, 4].map(
+    i => view.getUint32(4 * i, true),
+  );
+
+  const numIn = n1 + n2;
+  const outputStart = numWire - n3;
+
+  if (outputStart < numIn) {
+    throw new Error('Circuit inputs and outputs overlap');
+  }
+
+  // A literal is 2 * node + negated. Node 0 is the constant false, nodes
+  // 1..numIn are the inputs and later nodes are XOR/AND gates.
+  const FALSE = 0;
+  const TRUE = 1;
+  const XOR = 1;
+  const AND = 2;
+
+  const wireLit = new Int32Array(numWire).fill(-1);
+  for (let i = 0; i < numIn; i++) {
+    wireLit[i] = 2 * (i + 1);
+  }
+
+  const nodeCode: number[] = [];
+  const nodeIn: number[] = []; // two entries per gate node
+  const firstGateNode = numIn + 1;
+  const known = new Map<string, number>();
+
+  const readLit = (w: number) => {
+    if (w >= numWire || wireLit[w] < 0) {
+      throw new Error(`Wire ${w} read before it is written`);
+    }
+
+    return wireLit[w];
+  };
+
+  const addNode = (code: number, a: number, b: number) => {
+    const key = `${code}:${a}:${b}`;
+    let node = known.get(key);
+
+    if (node === undefined) {
+      node = firstGateNode + nodeCode.length;
+      nodeCode.push(code);
+      nodeIn.push(a, b);
+      known.set(key, node);
+    }
+
+    return node;
+  };
+
+  const xorLit = (a: number, b: number) => {
+    const neg = (a ^ b) & 1;
+    let [na, nb] = [a >> 1, b >> 1];
+
+    if (na === nb) return neg;
+    if (na === 0) return 2 * nb + neg;
+    if (nb === 0) return 2 * na + neg;
+    if (na > nb) [na, nb] = [nb, na];
+
+    return 2 * addNode(XOR, 2 * na, 2 * nb) + neg;
+  };
+
+  const andLit = (a: number, b: number) => {
+    if (a === FALSE || b === FALSE) return FALSE;
+    if (a === TRUE) return b;
+    if (b === TRUE) return a;
+    if (a === b) return a;
+    if ((a ^ b) === 1) return FALSE;
+    if (a > b) [a, b] = [b, a];
+
+    return 2 * addNode(AND, a, b);
+  };
+
+  let andsBefore = 0;
+  let off = 20;
+
+  for (let g = 0; g < numGate; g++) {
+    if (off >= circuitBinary.byteLength) {
+      throw new Error('Fewer gates than the header says');
+    }
+
+    const code = view.getUint8(off);
+    const wireCount = code === 0 ? 2 : 3;
+
+    if (code > 2) {
+      throw new Error(`Unknown gate code ${code} at byte ${off}`);
+    }
+
+    if (off + 1 + 4 * wireCount > circuitBinary.byteLength) {
+      throw new Error('Truncated wire index');
+    }
+
+    const w = [0, 1, 2].slice(0, wireCount).map(
+      j => view.getUint32(off + 1 + 4 * j, true),
+    );
+    const out = w[wireCount - 1];
+
+    if (out >= numWire) {
+      throw new Error(`Wire ${out} out of range`);
+    }
+
+    if (code === 0) {
+      wireLit[out] = readLit(w[0]) ^ 1;
+    } else if (code === XOR) {
+      wireLit[out] = xorLit(readLit(w[0]), readLit(w[1]));
+    } else {
+      wireLit[out] = andLit(readLit(w[0]), readLit(w[1]));
+      andsBefore++;
+    }
+
+    off += 1 + 4 * wireCount;
+  }
+
+  if (off !== circuitBinary.byteLength) {
+    throw new Error('More gates than the header says');
+  }
+
+  const outputLits: number[] = [];
+  for (let i = 0; i < n3; i++) {
+    outputLits.push(readLit(outputStart + i));
+  }
+
+  /* ---------- keep only what the outputs depend on ---------- */
+  const numNodes = firstGateNode + nodeCode.length;
+  const live = new Uint8Array(numNodes);
+  let needFalse = false;
+
+  for (const lit of outputLits) {
+    live[lit >> 1] = 1;
+    needFalse ||= (lit >> 1) === 0;
+  }
+
+  // gate nodes only refer to earlier nodes
+  for (let node = numNodes - 1; node >= firstGateNode; node--) {
+    if (live[node]) {
+      const k = node - firstGateNode;
+      live[nodeIn[2 * k] >> 1] = 1;
+      live[nodeIn[2 * k + 1] >> 1] = 1;
+    }
+  }
+
+  if (needFalse && numIn === 0) {
+    throw new Error('Cannot build a constant output without inputs');
+  }
+
+  /* ---------- emit ---------- */
+  // Wire references below numIn are inputs, -(i + 1) is output i and
+  // anything else is a fresh internal wire (numbered after the inputs).
+  type Gate = { code: number, wires: number[] };
+  const gates: Gate[] = [];
+  let internalWires = 0;
+  const newWire = () => numIn + internalWires++;
+
+  // a gate node can write straight to the first output that uses it as is
+  const UNASSIGNED = 0x7fffffff;
+  const nodeWire = new Int32Array(numNodes).fill(UNASSIGNED);
+  const claimed = new Uint8Array(n3);
+
+  outputLits.forEach((lit, i) => {
+    const node = lit >> 1;
+
+    if ((lit & 1) === 0 && node >= firstGateNode && nodeWire[node] === UNASSIGNED) {
+      nodeWire[node] = -(i + 1);
+      claimed[i] = 1;
+    }
+  });
+
+  for (let i = 0; i < numIn; i++) {
+    nodeWire[i + 1] = i;
+  }
+
+  if (needFalse) {
+    nodeWire[0] = newWire();
+    gates.push({ code: XOR, wires: [0, 0, nodeWire[0]] });
+  }
+
+  const negWire = new Map<number, number>();
+  const litWire = (lit: number) => {
+    const node = lit >> 1;
+
+    if ((lit & 1) === 0) return nodeWire[node];
+
+    let w = negWire.get(node);
+
+    if (w === undefined) {
+      w = newWire();
+      negWire.set(node, w);
+      gates.push({ code: 0, wires: [nodeWire[node], w] });
+    }
+
+    return w;
+  };
+
+  let andsAfter = 0;
+
+  for (let node = firstGateNode; node < numNodes; node++) {
+    if (!live[node]) continue;
+
+    const k = node - firstGateNode;
+    const code = nodeCode[k];
+
+    if (nodeWire[node] === UNASSIGNED) {
+      nodeWire[node] = newWire();
+    }
+
+    if (code === XOR) {
+      // XOR inputs are never negated, the negation lives in the literal
+      gates.push({
+        code,
+        wires: [litWire(nodeIn[2 * k]), litWire(nodeIn[2 * k + 1]), nodeWire[node]],
+      });
+    } else {
+      const a = litWire(nodeIn[2 * k]);
+      const b = litWire(nodeIn[2 * k + 1]);
+      gates.push({ code, wires: [a, b, nodeWire[node]] });
+      andsAfter++;
+    }
+  }
+
+  outputLits.forEach((lit, i) => {
+    if (claimed[i]) return;
+
+    const src = nodeWire[lit >> 1];
+
+    if (lit & 1) {
+      gates.push({ code: 0, wires: [src, -(i + 1)] });
+    } else {
+      // no copy gate, so invert twice
+      const tmp = newWire();
+      gates.push({ code: 0, wires: [src, tmp] });
+      gates.push({ code: 0, wires: [tmp, -(i + 1)] });
+    }
+  });
+
+  const newNumWire = numIn + internalWires + n3;
+  const mapWire = (w: number) => w < 0 ? newNumWire - n3 + (-w - 1) : w;
+
+  const byteLength = 20 + gates.reduce((sum, g) => sum + 1 + 4 * g.wires.length, 0);
+  const result = new Uint8Array(byteLength);
+  const outView = new DataView(result.buffer);
+
+  [gates.length, newNumWire, n1, n2, n3].forEach(
+    (v, i) => outView.setUint32(4 * i, v, true),
+  );
+
+  off = 20;
+
+  for (const { code, wires } of gates) {
+    outView.setUint8(off, code);
+
+    wires.forEach((w, j) => outView.setUint32(off + 1 + 4 * j, mapWire(w), true));
+    off += 1 + 4 * wires.length;
+  }
+
+  return {
+    circuit: result,
+    report: {
+      gatesBefore: numGate,
+      gatesAfter: gates.length,
+      andsBefore,
+      andsAfter,
+    },
+  };
+}
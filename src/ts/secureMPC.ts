@@ -1,8 +1,8 @@
 import { EventEmitter } from "ee-typed";
-import type { IO } from "./types";
+import type { IO, MemoryReport, MPCProgress } from "./types";
 import workerCode from "./workerCode.js";
 import nodeSecureMPC from "./nodeSecureMPC.js";
-import bristolToBinary from "./bristolToBinary.js";
+import { CircuitCache, defaultCircuitCache } from "./circuitCache.js";
 
 export type SecureMPC = typeof secureMPC;
 
@@ -19,22 +19,37 @@ const getWorkerUrl = (() => {
   }
 })();
 
-export default function secureMPC({
+export default async function secureMPC({
   party, size, circuit, inputBits, inputBitsPerParty, io, mode = 'auto',
+  statisticalSecurity = 40, evaluator = 0, optimize = false,
+  circuitCache = defaultCircuitCache, outputBitsPerParty, onPhase,
+  onTrace, onProgress, onMemory,
 }: {
   party: number,
   size: number,
-  circuit: string,
+  circuit: string | Uint8Array,
   inputBits: Uint8Array,
   inputBitsPerParty: number[],
   io: IO,
   mode?: '2pc' | 'mpc' | 'auto',
+  statisticalSecurity?: number,
+  evaluator?: number,
+  optimize?: boolean,
+  circuitCache?: CircuitCache,
+  outputBitsPerParty?: number[],
+  onPhase?: (phase: string, heapBytes: number) => void,
+  onTrace?: (traceJson: string) => void,
+  onProgress?: (progress: MPCProgress) => void,
+  onMemory?: (report: MemoryReport) => void,
 }): Promise<Uint8Array> {
-  const circuitBinary = bristolToBinary(circuit);
+  // a Uint8Array is taken to be in bristolToBinary's layout already
+  const circuitBinary = await circuitCache.getBinary(circuit, { optimize });
 
   if (typeof Worker === 'undefined') {
     return nodeSecureMPC({
       party, size, circuitBinary, inputBits, inputBitsPerParty, io, mode,
+      statisticalSecurity, evaluator, outputBitsPerParty, onPhase, onTrace,
+      onProgress, onMemory,
     });
   }
 
@@ -55,6 +70,10 @@ export default function secureMPC({
       inputBits,
       inputBitsPerParty,
       mode,
+      statisticalSecurity, evaluator, outputBitsPerParty,
+      trace: onTrace !== undefined,
+      progress: onProgress !== undefined,
+      memory: onMemory !== undefined,
     });
 
     worker.onmessage = async (event) => {
@@ -77,6 +96,14 @@ export default function secureMPC({
             error: (error as Error).message,
           });
         }
+      } else if (message.type === 'phase') {
+        onPhase?.(message.phase, message.heapBytes);
+      } else if (message.type === 'trace') {
+        onTrace?.(message.traceJson);
+      } else if (message.type === 'progress') {
+        onProgress?.(message.progress);
+      } else if (message.type === 'memory') {
+        onMemory?.(message.report);
       } else if (message.type === 'result') {
         // Resolve the promise with the result from the worker
         resolve(message.result);
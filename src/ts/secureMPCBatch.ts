@@ -0,0 +1,88 @@
+import type { IO, MemoryReport, MPCProgress } from "./types";
+import secureMPC from "./secureMPC.js";
+import batchCircuit from "./batchCircuit.js";
+import { CircuitCache, defaultCircuitCache } from "./circuitCache.js";
+
+/**
+ * Evaluates the same circuit on a batch of inputs in one secureMPC session,
+ * so setup and preprocessing checks are paid once for the whole batch.
+ *
+ * @param inputBatch - This party's input bits for each evaluation. All parties
+ *   must pass the same number of entries (empty ones if they have no inputs).
+ * @param inputBitsPerParty - The number of input bits for each party in a
+ *   single evaluation.
+ * @param outputBitsPerParty - If given, the number of output bits that go to
+ *   each party in a single evaluation, as for secureMPC.
+ * @returns The output bits of each evaluation, in the order of inputBatch
+ *   (only this party's group of them if outputBitsPerParty is given).
+ *
+ * The other parameters are as for secureMPC. onPhase, onTrace, onProgress
+ * and onMemory describe the session as a whole, so progress counts the gates
+ * of all evaluations together.
+ */
+export default async function secureMPCBatch({
+  party, size, circuit, inputBatch, inputBitsPerParty, io, mode = 'auto',
+  statisticalSecurity = 40, evaluator = 0, optimize = false,
+  circuitCache = defaultCircuitCache, outputBitsPerParty, onPhase, onTrace,
+  onProgress, onMemory,
+}: {
+  party: number,
+  size: number,
+  circuit: string,
+  inputBatch: Uint8Array[],
+  inputBitsPerParty: number[],
+  io: IO,
+  mode?: '2pc' | 'mpc' | 'auto',
+  statisticalSecurity?: number,
+  evaluator?: number,
+  optimize?: boolean,
+  circuitCache?: CircuitCache,
+  outputBitsPerParty?: number[],
+  onPhase?: (phase: string, heapBytes: number) => void,
+  onTrace?: (traceJson: string) => void,
+  onProgress?: (progress: MPCProgress) => void,
+  onMemory?: (report: MemoryReport) => void,
+}): Promise<Uint8Array[]> {
+  const count = inputBatch.length;
+  const ownBits = inputBitsPerParty[party];
+
+  for (const bits of inputBatch) {
+    if (bits.length !== ownBits) {
+      throw new Error('Mismatch between inputBatch and inputBitsPerParty');
+    }
+  }
+
+  // optimizing before batching does the work once rather than per copy
+  const circuitBinary = batchCircuit(
+    await circuitCache.getBinary(circuit, { optimize }),
+    inputBitsPerParty,
+    count,
+    outputBitsPerParty,
+  );
+
+  const inputBits = new Uint8Array(count * ownBits);
+  inputBatch.forEach((bits, k) => inputBits.set(bits, k * ownBits));
+
+  const outputBits = await secureMPC({
+    party,
+    size,
+    circuit: circuitBinary,
+    inputBits,
+    inputBitsPerParty: inputBitsPerParty.map(bits => bits * count),
+    io,
+    mode,
+    statisticalSecurity,
+    evaluator,
+    outputBitsPerParty: outputBitsPerParty?.map(bits => bits * count),
+    onPhase,
+    onTrace,
+    onProgress,
+    onMemory,
+  });
+
+  const outputLen = outputBits.length / count;
+
+  return inputBatch.map(
+    (_bits, k) => outputBits.slice(k * outputLen, (k + 1) * outputLen),
+  );
+}
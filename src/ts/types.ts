@@ -5,3 +5,35 @@ export type IO = {
   off?: (event: 'error', listener: (error: Error) => void) => void;
   close?: () => void;
 };
+
+/**
+ * How far a run has got, see the onProgress option of secureMPC. `done` and
+ * `total` count gates, or AND gates while preprocessing; the bytes are totals
+ * over all channels so far. If updates stop coming while the bytes stand
+ * still, a peer has stalled.
+ */
+export type MPCProgress = {
+  phase: 'function_independent' | 'function_dependent' | 'online',
+  done: number,
+  total: number,
+  bytesSent: number,
+  bytesReceived: number,
+  /** Time left in this phase at the rate so far, once there is one. */
+  phaseEtaMs?: number,
+};
+
+/**
+ * The protocol's big buffers at the end of a phase, see the onMemory option
+ * of secureMPC. Only tagged buffers are counted (see mem_account.h), so
+ * `live` and `peak` are a lower bound on what the run needs; `heapBytes` is
+ * the size the Wasm heap has grown to. Peaks are since the start of the run,
+ * `phasePeak` since the start of this phase.
+ */
+export type MemoryReport = {
+  phase: 'setup' | 'function_independent' | 'function_dependent' | 'online',
+  live: number,
+  peak: number,
+  phasePeak: number,
+  heapBytes: number,
+  buffers: { name: string, live: number, peak: number }[],
+};
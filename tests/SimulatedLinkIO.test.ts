@@ -0,0 +1,41 @@
+import { expect } from "chai";
+
+import BufferQueue from '../src/ts/BufferQueue';
+import SimulatedLinkIO from '../src/ts/SimulatedLinkIO';
+import type { IO } from '../src/ts/types';
+
+function loopback(): IO {
+  const q = { a: new BufferQueue(), b: new BufferQueue() };
+
+  return {
+    send: (_toParty, channel, data) => q[channel].push(data),
+    recv: (_fromParty, channel, minLen, maxLen) => q[channel].pop(minLen, maxLen),
+  };
+}
+
+describe("SimulatedLinkIO", () => {
+  it("delays delivery by the latency and bandwidth", async () => {
+    const io = new SimulatedLinkIO(loopback(), { latency: 30, bandwidth: 10_000 });
+    const start = performance.now();
+
+    // 200 bytes take 20 ms at 10 kB/s
+    io.send(1, 'a', new Uint8Array(200));
+    await io.recv(1, 'a', 200, 200);
+
+    expect(performance.now() - start).to.be.greaterThanOrEqual(49);
+  });
+
+  it("keeps each link in order despite jitter", async () => {
+    const io = new SimulatedLinkIO(loopback(), { latency: 1, jitter: 20, seed: 7 });
+
+    for (let i = 0; i < 50; i++) {
+      io.send(1, i % 2 === 0 ? 'a' : 'b', new Uint8Array([i]));
+    }
+
+    const a = await io.recv(1, 'a', 25, 25);
+    const b = await io.recv(1, 'b', 25, 25);
+
+    expect([...a]).to.deep.equal(Array.from({ length: 25 }, (_, i) => 2 * i));
+    expect([...b]).to.deep.equal(Array.from({ length: 25 }, (_, i) => 2 * i + 1));
+  });
+});
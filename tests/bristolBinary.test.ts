@@ -37,6 +37,20 @@ describe("Bristol ⇆ Binary round-trip", () => {
     });
   });
 
+  it("Bristol Fashion headers give the same binary", () => {
+    const gates = `
+1 1 0 3 INV
+2 1 1 2 4 AND
+2 1 3 4 5 XOR`;
+
+    expect(bristolToBinary(`3 6\n2 1 2\n1 2\n${gates}`))
+      .to.deep.equal(bristolToBinary(`3 6\n1 2 2\n${gates}`));
+
+    // other numbers of input groups are summed into n1
+    expect(bristolToBinary(`3 6\n3 1 1 1\n2 1 1\n${gates}`))
+      .to.deep.equal(bristolToBinary(`3 6\n3 0 2\n${gates}`));
+  });
+
   it("decoding an opcode-corrupted buffer should throw", () => {
     const good = bristolToBinary(samples[0]);
 
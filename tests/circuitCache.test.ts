@@ -0,0 +1,65 @@
+import fs from 'fs/promises';
+import os from 'os';
+import path from 'path';
+
+import { expect } from "chai";
+
+import bristolToBinary from '../src/ts/bristolToBinary';
+import { CircuitCache, nodeDiskStore } from '../src/ts/circuitCache';
+
+const circuit = `2 3
+1 0 0
+
+1 1 0 1 INV
+2 1 0 1 2 AND`;
+
+describe("CircuitCache", () => {
+  it("parses equal circuits once", async () => {
+    const cache = new CircuitCache();
+
+    // built at runtime, so the two strings are distinct objects
+    const a = await cache.getBinary(circuit.split('\n').join('\n'));
+    const b = await cache.getBinary([circuit].join(''));
+
+    expect(a).to.equal(b);
+    expect(a).to.deep.equal(bristolToBinary(circuit));
+  });
+
+  it("keeps optimized binaries apart", async () => {
+    const cache = new CircuitCache();
+
+    const plain = await cache.getBinary(circuit);
+    const optimized = await cache.getBinary(circuit, { optimize: true });
+
+    expect(optimized).to.not.deep.equal(plain);
+    expect(await cache.getBinary(circuit, { optimize: true })).to.equal(optimized);
+  });
+
+  it("evicts the least recently used binary", async () => {
+    const other = circuit.replace('INV', 'INV\n1 1 0 1 INV').replace('2 3', '3 3');
+    const size = bristolToBinary(circuit).byteLength;
+    const cache = new CircuitCache({ maxBytes: 2 * size + 9 });
+
+    const first = await cache.getBinary(circuit);
+    await cache.getBinary(other);
+    await cache.getBinary(circuit);
+    await cache.getBinary(circuit, { optimize: true });
+
+    // `other` went out, the more recently used `circuit` stayed
+    expect(await cache.getBinary(circuit)).to.equal(first);
+  });
+
+  it("persists binaries to disk", async () => {
+    const dir = await fs.mkdtemp(path.join(os.tmpdir(), 'emp-wasm-'));
+
+    try {
+      const binary = await new CircuitCache({ store: nodeDiskStore(dir) }).getBinary(circuit);
+      expect(await fs.readdir(dir)).to.have.length(1);
+
+      const reloaded = await new CircuitCache({ store: nodeDiskStore(dir) }).getBinary(circuit);
+      expect(reloaded).to.deep.equal(binary);
+    } finally {
+      await fs.rm(dir, { recursive: true });
+    }
+  });
+});
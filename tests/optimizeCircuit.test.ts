@@ -0,0 +1,103 @@
+import fs from 'fs/promises';
+
+import { expect } from "chai";
+
+import bristolToBinary from '../src/ts/bristolToBinary';
+import optimizeCircuit from '../src/ts/optimizeCircuit';
+
+// plaintext evaluation of a circuit in bristolToBinary's layout
+function evaluate(circuitBinary: Uint8Array, inputs: number[]): number[] {
+  const view = new DataView(
+    circuitBinary.buffer,
+    circuitBinary.byteOffset,
+    circuitBinary.byteLength,
+  );
+  const [numGate, numWire, , , n3] = [0, 1, 2, 3, 4].map(
+    i => view.getUint32(4 * i, true),
+  );
+
+  const wires = new Uint8Array(numWire);
+  wires.set(inputs);
+
+  let off = 20;
+
+  for (let g = 0; g < numGate; g++) {
+    const code = view.getUint8(off);
+    const a = view.getUint32(off + 1, true);
+    const b = view.getUint32(off + 5, true);
+
+    if (code === 0) {
+      wires[b] = 1 - wires[a];
+      off += 9;
+    } else {
+      const out = view.getUint32(off + 9, true);
+      wires[out] = code === 1 ? wires[a] ^ wires[b] : wires[a] & wires[b];
+      off += 13;
+    }
+  }
+
+  return Array.from(wires.slice(numWire - n3));
+}
+
+function randomBits(n: number) {
+  return Array.from({ length: n }, () => Math.random() < 0.5 ? 1 : 0);
+}
+
+describe("optimizeCircuit", () => {
+  it("removes redundant gates", () => {
+    // inputs 0, 1 (party 0) and 2 (party 1); outputs 13..16 are
+    // ¬(0 ∧ 1), 0 ∧ ¬0, (2 ∧ 2) ⊕ 2 and ¬0. Wires 7 and 9 are unused, and
+    // AND(¬¬0, 1) duplicates AND(0, 1).
+    const circuit = bristolToBinary(`13 17
+2 1 4
+
+1 1 0 3 INV
+1 1 3 4 INV
+2 1 4 1 5 AND
+2 1 0 1 6 AND
+2 1 5 6 7 XOR
+2 1 0 0 8 XOR
+2 1 8 2 9 AND
+2 1 2 2 10 AND
+2 1 1 0 11 AND
+1 1 11 13 INV
+2 1 3 0 14 AND
+2 1 10 2 15 XOR
+1 1 0 16 INV`);
+
+    const { circuit: optimized, report } = optimizeCircuit(circuit);
+
+    expect(report).to.deep.equal({
+      gatesBefore: 13,
+      gatesAfter: 8,
+      andsBefore: 6,
+      andsAfter: 1,
+    });
+
+    for (let x = 0; x < 8; x++) {
+      const inputs = [x & 1, (x >> 1) & 1, (x >> 2) & 1];
+      expect(evaluate(optimized, inputs)).to.deep.equal(evaluate(circuit, inputs));
+    }
+  });
+
+  for (const [name, inputBits] of [['adder_32bit.txt', 64], ['sha-1.txt', 512]] as const) {
+    it(`keeps ${name} equivalent`, async () => {
+      const circuit = bristolToBinary(await getCircuit(name));
+      const { circuit: optimized, report } = optimizeCircuit(circuit);
+
+      expect(report.andsAfter).to.be.at.most(report.andsBefore);
+
+      for (let i = 0; i < 10; i++) {
+        const inputs = randomBits(inputBits);
+        expect(evaluate(optimized, inputs)).to.deep.equal(evaluate(circuit, inputs));
+      }
+    });
+  }
+});
+
+async function getCircuit(name: string) {
+  return await fs.readFile(
+    import.meta.resolve(`../circuits/${name}`).slice(7),
+    'utf-8',
+  );
+}
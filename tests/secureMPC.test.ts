@@ -3,7 +3,7 @@ import { exec } from 'child_process';
 import { promisify } from 'util';
 
 import { expect } from 'chai';
-import { BufferQueue, secureMPC } from "../src/ts";
+import { BufferQueue, secureMPC, secureMPCBatch, type MemoryReport, type MPCProgress } from "../src/ts";
 
 describe('Secure MPC', () => {
   it('3 + 5 == 8 (2pc)', async function () {
@@ -20,11 +20,121 @@ describe('Secure MPC', () => {
     expect(await internalDemo(3, 5, 'auto')).to.deep.equal({ alice: 8, bob: 8 });
   });
 
+  it('3 + 5 == 8 (optimized)', async function () {
+    expect(await internalDemo(3, 5, 'auto', true)).to.deep.equal({ alice: 8, bob: 8 });
+  });
+
+  for (const mode of ['2pc', 'mpc'] as const) {
+    it(`1000 + 70000 split between parties (${mode})`, async function () {
+      // 71000 = 1 * 2^16 + 5464: alice only gets the low 16 of the 33 output
+      // bits, bob the rest
+      expect(await internalDemo(1000, 70000, mode, false, [16, 17]))
+        .to.deep.equal({ alice: 5464, bob: 1 });
+    });
+  }
+
+  it('reports each phase', async function () {
+    const phases: string[][] = [[], []];
+
+    await internalDemo(3, 5, 'mpc', false, undefined, {
+      onPhase: (party, phase) => phases[party].push(phase),
+    });
+
+    for (const p of phases) {
+      expect(p).to.deep.equal(
+        ['setup', 'function_independent', 'function_dependent', 'online'],
+      );
+    }
+  });
+
+  it('traces the protocol steps', async function () {
+    const names: string[][] = [[], []];
+
+    await internalDemo(3, 5, 'mpc', false, undefined, {
+      onTrace: (party, traceJson) => {
+        names[party] = JSON.parse(traceJson).traceEvents.map((e: { name: string }) => e.name);
+      },
+    });
+
+    for (const n of names) {
+      expect(n).to.include.members(
+        ['CMPC::function_independent', 'FpreMP::compute', 'ABitMP::check1', 'CMPC::online'],
+      );
+    }
+  });
+
+  for (const mode of ['2pc', 'mpc'] as const) {
+    it(`reports progress (${mode})`, async function () {
+      const updates: MPCProgress[][] = [[], []];
+
+      await internalDemo(3, 5, mode, false, undefined, {
+        onProgress: (party, progress) => updates[party].push(progress),
+      });
+
+      for (const u of updates) {
+        // every phase starts at 0 and finishes
+        for (const phase of ['function_independent', 'function_dependent', 'online']) {
+          const p = u.filter(x => x.phase === phase);
+          expect(p[0].done).to.equal(0);
+          expect(p[p.length - 1].done).to.equal(p[p.length - 1].total);
+        }
+
+        expect(u[u.length - 1].bytesSent).to.be.greaterThan(0);
+        expect(u[u.length - 1].bytesReceived).to.be.greaterThan(0);
+      }
+    });
+  }
+
+  for (const mode of ['2pc', 'mpc'] as const) {
+    it(`reports memory per phase (${mode})`, async function () {
+      const reports: MemoryReport[][] = [[], []];
+
+      await internalDemo(3, 5, mode, false, undefined, {
+        onMemory: (party, report) => reports[party].push(report),
+      });
+
+      for (const r of reports) {
+        expect(r.map(x => x.phase)).to.deep.equal(
+          ['setup', 'function_independent', 'function_dependent', 'online'],
+        );
+
+        const last = r[r.length - 1];
+        expect(last.peak).to.be.greaterThan(0);
+        expect(last.peak).to.be.at.most(last.heapBytes);
+
+        for (const x of r) {
+          expect(x.phasePeak).to.be.at.least(x.live);
+          expect(x.phasePeak).to.be.at.most(x.peak);
+        }
+
+        const prefix = mode === '2pc' ? 'C2PC::' : 'CMPC::';
+        expect(last.buffers.some(b => b.name.startsWith(prefix) && b.peak > 0)).to.equal(true);
+      }
+    });
+  }
+
   it('3 + 5 == 8 (5 parties)', async function () {
     this.timeout(20_000);
     expect(await internalDemoN(3, 5, 5)).to.deep.equal([8, 8, 8, 8, 8]);
   });
 
+  for (const mode of ['2pc', 'mpc'] as const) {
+    it(`[1, 3, 5] + [2, 4, 1000] == [3, 7, 1005] (batch, ${mode})`, async function () {
+      this.timeout(20_000);
+      expect(await internalBatchDemo([1, 3, 5], [2, 4, 1000], mode))
+        .to.deep.equal({ alice: [3, 7, 1005], bob: [3, 7, 1005] });
+    });
+
+    it(`[1000, 3] + [70000, 5] split between parties (batch, ${mode})`, async function () {
+      this.timeout(20_000);
+      const progress: MPCProgress[] = [];
+
+      expect(await internalBatchDemo([1000, 3], [70000, 5], mode, [16, 17], p => progress.push(p)))
+        .to.deep.equal({ alice: [5464, 8], bob: [1, 0] });
+      expect(progress.some(p => p.phase === 'online' && p.done === p.total)).to.equal(true);
+    });
+  }
+
   for (let nParties = 2; nParties <= 4; nParties++) {
     for (const flavor of ['internal    ', 'subprocesses']) {
       it(`sha1("") == "da..09" | ${nParties} parties | ${flavor}`, async function () {
@@ -64,6 +174,14 @@ async function internalDemo(
   aliceInput: number,
   bobInput: number,
   mode: '2pc' | 'mpc' | 'auto' = 'auto',
+  optimize = false,
+  outputBitsPerParty?: number[],
+  { onPhase, onTrace, onProgress, onMemory }: {
+    onPhase?: (party: number, phase: string) => void,
+    onTrace?: (party: number, traceJson: string) => void,
+    onProgress?: (party: number, progress: MPCProgress) => void,
+    onMemory?: (party: number, report: MemoryReport) => void,
+  } = {},
 ): Promise<{ alice: number, bob: number }> {
   const bqs = new BufferQueueStore();
   const add32BitCircuit = await getCircuit('adder_32bit.txt');
@@ -86,6 +204,12 @@ async function internalDemo(
         },
       },
       mode,
+      optimize,
+      outputBitsPerParty,
+      onPhase: phase => onPhase?.(0, phase),
+      onTrace: onTrace && (traceJson => onTrace(0, traceJson)),
+      onProgress: onProgress && (progress => onProgress(0, progress)),
+      onMemory: onMemory && (report => onMemory(0, report)),
     }),
     secureMPC({
       party: 1,
@@ -104,6 +228,12 @@ async function internalDemo(
         },
       },
       mode,
+      optimize,
+      outputBitsPerParty,
+      onPhase: phase => onPhase?.(1, phase),
+      onTrace: onTrace && (traceJson => onTrace(1, traceJson)),
+      onProgress: onProgress && (progress => onProgress(1, progress)),
+      onMemory: onMemory && (report => onMemory(1, report)),
     }),
   ]);
 
@@ -154,6 +284,43 @@ async function internalDemoN(
   return outputBits.map(bits => numberFrom32Bits(bits));
 }
 
+async function internalBatchDemo(
+  aliceInputs: number[],
+  bobInputs: number[],
+  mode: '2pc' | 'mpc',
+  outputBitsPerParty?: number[],
+  onProgress?: (progress: MPCProgress) => void,
+): Promise<{ alice: number[], bob: number[] }> {
+  const bqs = new BufferQueueStore();
+  const add32BitCircuit = await getCircuit('adder_32bit.txt');
+
+  const [aliceOutputs, bobOutputs] = await Promise.all(
+    [aliceInputs, bobInputs].map((inputs, party) => secureMPCBatch({
+      party,
+      size: 2,
+      circuit: add32BitCircuit,
+      inputBatch: inputs.map(numberTo32Bits),
+      inputBitsPerParty: [32, 32],
+      io: {
+        send: (toParty, channel, data) => {
+          bqs.get(party, toParty, channel).push(data);
+        },
+        recv: async (fromParty, channel, min_len, max_len) => {
+          return bqs.get(fromParty, party, channel).pop(min_len, max_len);
+        },
+      },
+      mode,
+      outputBitsPerParty,
+      onProgress,
+    })),
+  );
+
+  return {
+    alice: aliceOutputs.map(numberFrom32Bits),
+    bob: bobOutputs.map(numberFrom32Bits),
+  };
+}
+
 /**
  * Converts a number into its 32-bit binary representation.
  *